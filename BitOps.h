@@ -7,7 +7,9 @@ extern "C" {
 #endif
 
 
+#include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 
 /** The value corresponding to the bit.
@@ -42,8 +44,8 @@ extern "C" {
 @param i : (unsigned) int number
 @param b1 : int index of the first bit, starting from 0
 @param bn : int number of bits
-@return int Read value. */
-#define BITOPS_GET_BITS(i, b1, bn) (((i)>>(b1))&((1<<(bn))-1))
+@return unsigned int Read value. */
+#define BITOPS_GET_BITS(i, b1, bn) (((i)>>(b1))&((1u<<(bn))-1u))
 
 /** Extracting several bits from a number (64-bit version).
 @param i : unsigned long long number
@@ -56,7 +58,7 @@ extern "C" {
 @param i : (unsigned) int* variable for setting bits
 @param b : (unsigned) int bit index starting from 0
 @param v : (unsigned) int value to be set */
-#define BITOPS_SET_BIT(i, b, v) (*(i)&= ~(1<<(b)), *(i)|= ((v)&1)<<(b))
+#define BITOPS_SET_BIT(i, b, v) (*(i)&= ~(1u<<(b)), *(i)|= ((unsigned)(v)&1u)<<(b))
 
 /** Setting a bit in a number (64-bit version).
 @param i : unsigned long long* variable for setting bits
@@ -69,8 +71,8 @@ extern "C" {
 @param b1 : (unsigned) int index of the first bit, starting from 0
 @param bn : (unsigned) int number of bits
 @param v : (unsigned) int value to be set */
-#define BITOPS_SET_BITS(i, b1, bn, v) (*(i)&= ~(((1<<(bn))-1)<<(b1)), \
-		*(i)|= ((v)&((1<<(bn))-1))<<(b1))
+#define BITOPS_SET_BITS(i, b1, bn, v) (*(i)&= ~(((1u<<(bn))-1u)<<(b1)), \
+		*(i)|= ((unsigned)(v)&((1u<<(bn))-1u))<<(b1))
 
 /** Setting multiple bits in a number (64-bit version).
 @param i : unsigned long long* variable for setting bits
@@ -86,7 +88,7 @@ extern "C" {
  * @param bn : value width in bits
  * @return The read sign value. */
 #define BITOPS_GET_SIGNED_BITS(i, b1, bn) (BITOPS_GET_BIT((i), (b1) + (bn) - 1) ? \
-		-(signed)(BITOPS_GET_BITS(~(i), (b1), (bn) - 1) - 1) : (signed)BITOPS_GET_BITS((i), (b1), (bn) - 1))
+		-(signed)(BITOPS_GET_BITS(~(i), (b1), (bn) - 1) + 1) : (signed)BITOPS_GET_BITS((i), (b1), (bn) - 1))
 		
 /** Reading a signed value from an unsigned source.
  * @param i : unsigned long long value
@@ -94,7 +96,7 @@ extern "C" {
  * @param bn : value width in bits
  * @* @return signed long long unread signed value. */
 #define BITOPS_GET_SIGNED_BITS_64(i, b1, bn) (BITOPS_GET_BIT_64((i), (b1) + (bn) - 1) ? \
-        -(signed)(BITOPS_GET_BITS_64(~(i), (b1), (bn) - 1) - 1) : (signed)BITOPS_GET_BITS_64((i), (b1), (bn) - 1))
+        -(long long)(BITOPS_GET_BITS_64(~(i), (b1), (bn) - 1) + 1) : (long long)BITOPS_GET_BITS_64((i), (b1), (bn) - 1))
 
 /** Setting or resetting the flag.
  * @param flags : int* variable for setting or resetting the flag
@@ -130,18 +132,18 @@ extern "C" {
 /** Reading a 32-bit unsigned number with the highest byte forward.
 @param c : const void* initial read address
 @return uint32_t Read value. */
-#define BITOPS_READ_U32B(c) ((*((const uint8_t*)(c))<<24)| \
-		(*((const uint8_t*)(c)+1)<<16)| \
-		(*((const uint8_t*)(c)+2)<<8)| \
-		(*((const uint8_t*)(c)+3)))
+#define BITOPS_READ_U32B(c) (((uint32_t)*((const uint8_t*)(c))<<24)| \
+		((uint32_t)*((const uint8_t*)(c)+1)<<16)| \
+		((uint32_t)*((const uint8_t*)(c)+2)<<8)| \
+		((uint32_t)*((const uint8_t*)(c)+3)))
 
 /** Reading a 32-bit unsigned number with the lowest byte forward.
 @param c : const void* initial read address
 @return uint32_t Read value. */
-#define BITOPS_READ_U32L(c) ((*((const uint8_t*)(c)))| \
-		(*((const uint8_t*)(c)+1)<<8)| \
-		(*((const uint8_t*)(c)+2)<<16)| \
-		(*((const uint8_t*)(c)+3)<<24))
+#define BITOPS_READ_U32L(c) (((uint32_t)*((const uint8_t*)(c)))| \
+		((uint32_t)*((const uint8_t*)(c)+1)<<8)| \
+		((uint32_t)*((const uint8_t*)(c)+2)<<16)| \
+		((uint32_t)*((const uint8_t*)(c)+3)<<24))
 
 /** Reading a 64-bit unsigned number with the highest byte forward.
 @param c : const void* initial read address
@@ -301,25 +303,25 @@ extern "C" {
  * @param v uint8_t value
  * @* @param int bitn number of bits to use
  * @return int8_t read signed value */
-#define BITOPS_UINT8_TO_INT8(v, bitn) (((bitn) == sizeof(v) * 8) ? (int8_t)(v) : AFC_GET_SIGNED_BITS((v), 0, (bitn)))
+#define BITOPS_UINT8_TO_INT8(v, bitn) (((bitn) == sizeof(v) * 8) ? (int8_t)(v) : (int8_t)BITOPS_GET_SIGNED_BITS((v), 0, (bitn)))
 
 /** Converting an integer or part of a 16-bit number to a signed number.
  * @param v uint16_t value
  * @* @param int bitn number of bits to use
  * @return int16_t read signed value */
-#define BITOPS_UINT16_TO_INT16(v, bitn) (((bitn) == sizeof(v) * 8) ? (int16_t)(v) : AFC_GET_SIGNED_BITS((v), 0, (bitn)))
+#define BITOPS_UINT16_TO_INT16(v, bitn) (((bitn) == sizeof(v) * 8) ? (int16_t)(v) : (int16_t)BITOPS_GET_SIGNED_BITS((v), 0, (bitn)))
 
 /** Converting an integer or part of a 32-bit number to a signed number.
  * @param v uint32_t value
  * @* @param int bitn number of bits to use
  * @return int32_t read signed value */
-#define BITOPS_UINT32_TO_INT32(v, bitn) (((bitn) == sizeof(v) * 8) ? (int32_t)(v) : AFC_GET_SIGNED_BITS((v), 0, (bitn)))
+#define BITOPS_UINT32_TO_INT32(v, bitn) (((bitn) == sizeof(v) * 8) ? (int32_t)(v) : (int32_t)BITOPS_GET_SIGNED_BITS((v), 0, (bitn)))
 
 /** Converting an integer or part of a 64-bit number to a signed number.
  * @param v uint64_t value
  * @* @param int bitn number of bits to use
  * @return int64_t read signed value */
-#define BITOPS_UINT64_TO_INT64(v, bitn) (((bitn) == sizeof(v) * 8) ? (int64_t)(v) : AFC_GET_SIGNED_BITS((v), 0, (bitn)))
+#define BITOPS_UINT64_TO_INT64(v, bitn) (((bitn) == sizeof(v) * 8) ? (int64_t)(v) : (int64_t)BITOPS_GET_SIGNED_BITS_64((v), 0, (bitn)))
 
 
 /** Getting an element in a two-dimensional array in which the data is arranged in rows.
@@ -331,6 +333,372 @@ extern "C" {
 #define BITOPS_EL2(a, xc, x, y) ((a)[(y)*(xc)+(x)])
 
 
+/* Type-safe function equivalents of the macros above and bulk array variants.
+ * Bulk loops are kept free of aliasing and data-dependent branches so the compiler vectorizes them at -O2/-O3. */
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BITOPS_BSWAP16(v) __builtin_bswap16(v)
+#define BITOPS_BSWAP32(v) __builtin_bswap32(v)
+#define BITOPS_BSWAP64(v) __builtin_bswap64(v)
+#endif
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define BITOPS_LITTLE_ENDIAN
+#elif defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define BITOPS_BIG_ENDIAN
+#endif
+
+#if defined(__cplusplus)
+#define BITOPS_RESTRICT
+#else
+#define BITOPS_RESTRICT restrict
+#endif
+
+/** Mask with the lowest bits set.
+@param bn : number of bits, 0..32
+@return uint32_t Mask value. */
+static inline uint32_t BitOps_Mask32(unsigned bn) {
+	return bn >= 32 ? 0xffffffffu : (1u << bn) - 1u;
+}
+
+/** Mask with the lowest bits set (64-bit version).
+@param bn : number of bits, 0..64
+@return uint64_t Mask value. */
+static inline uint64_t BitOps_Mask64(unsigned bn) {
+	return bn >= 64 ? 0xffffffffffffffffull : (1ull << bn) - 1ull;
+}
+
+/** Selecting several bits from a number.
+@param i : source value
+@param b1 : index of the first bit, starting from 0
+@param bn : number of bits
+@return uint32_t Read value. */
+static inline uint32_t BitOps_GetBits32(uint32_t i, unsigned b1, unsigned bn) {
+	return (i >> b1) & BitOps_Mask32(bn);
+}
+
+/** Selecting several bits from a number (64-bit version).
+@param i : source value
+@param b1 : index of the first bit, starting from 0
+@param bn : number of bits
+@return uint64_t Read value. */
+static inline uint64_t BitOps_GetBits64(uint64_t i, unsigned b1, unsigned bn) {
+	return (i >> b1) & BitOps_Mask64(bn);
+}
+
+/** Setting multiple bits in a number.
+@param i : source value
+@param b1 : index of the first bit, starting from 0
+@param bn : number of bits
+@param v : value to be set
+@return uint32_t Source value with the bits replaced. */
+static inline uint32_t BitOps_SetBits32(uint32_t i, unsigned b1, unsigned bn, uint32_t v) {
+	uint32_t mask = BitOps_Mask32(bn) << b1;
+	return (i & ~mask) | ((v << b1) & mask);
+}
+
+/** Setting multiple bits in a number (64-bit version).
+@param i : source value
+@param b1 : index of the first bit, starting from 0
+@param bn : number of bits
+@param v : value to be set
+@return uint64_t Source value with the bits replaced. */
+static inline uint64_t BitOps_SetBits64(uint64_t i, unsigned b1, unsigned bn, uint64_t v) {
+	uint64_t mask = BitOps_Mask64(bn) << b1;
+	return (i & ~mask) | ((v << b1) & mask);
+}
+
+/** Reading a signed (two's complement) value from an unsigned source.
+@param i : source value
+@param b1 : index of the first bit, starting from 0
+@param bn : value width in bits, 1..32
+@return int32_t Read value. */
+static inline int32_t BitOps_GetSignedBits32(uint32_t i, unsigned b1, unsigned bn) {
+	uint32_t sign = 1u << (bn - 1);
+	uint32_t v = BitOps_GetBits32(i, b1, bn);
+	return (int32_t)((v ^ sign) - sign);
+}
+
+/** Reading a signed (two's complement) value from an unsigned source (64-bit version).
+@param i : source value
+@param b1 : index of the first bit, starting from 0
+@param bn : value width in bits, 1..64
+@return int64_t Read value. */
+static inline int64_t BitOps_GetSignedBits64(uint64_t i, unsigned b1, unsigned bn) {
+	uint64_t sign = 1ull << (bn - 1);
+	uint64_t v = BitOps_GetBits64(i, b1, bn);
+	return (int64_t)((v ^ sign) - sign);
+}
+
+/** Reversing byte order of a 16-bit value. */
+static inline uint16_t BitOps_Bswap16(uint16_t v) {
+#ifdef BITOPS_BSWAP16
+	return BITOPS_BSWAP16(v);
+#else
+	return (uint16_t)((v >> 8) | (v << 8));
+#endif
+}
+
+/** Reversing byte order of a 32-bit value. */
+static inline uint32_t BitOps_Bswap32(uint32_t v) {
+#ifdef BITOPS_BSWAP32
+	return BITOPS_BSWAP32(v);
+#else
+	return (v >> 24) | ((v >> 8) & 0x0000ff00u) | ((v << 8) & 0x00ff0000u) | (v << 24);
+#endif
+}
+
+/** Reversing byte order of a 64-bit value. */
+static inline uint64_t BitOps_Bswap64(uint64_t v) {
+#ifdef BITOPS_BSWAP64
+	return BITOPS_BSWAP64(v);
+#else
+	return ((uint64_t)BitOps_Bswap32((uint32_t)v) << 32) | BitOps_Bswap32((uint32_t)(v >> 32));
+#endif
+}
+
+/** Reading a 16-bit unsigned number with the highest byte forward. */
+static inline uint16_t BitOps_ReadU16B(const void *c) {
+	return (uint16_t)BITOPS_READ_U16B(c);
+}
+
+/** Reading a 16-bit unsigned number with the lowest byte forward. */
+static inline uint16_t BitOps_ReadU16L(const void *c) {
+	return (uint16_t)BITOPS_READ_U16L(c);
+}
+
+/** Reading a 32-bit unsigned number with the highest byte forward. */
+static inline uint32_t BitOps_ReadU32B(const void *c) {
+	return BITOPS_READ_U32B(c);
+}
+
+/** Reading a 32-bit unsigned number with the lowest byte forward. */
+static inline uint32_t BitOps_ReadU32L(const void *c) {
+	return BITOPS_READ_U32L(c);
+}
+
+/** Reading a 64-bit unsigned number with the highest byte forward. */
+static inline uint64_t BitOps_ReadU64B(const void *c) {
+	return BITOPS_READ_U64B(c);
+}
+
+/** Reading a 64-bit unsigned number with the lowest byte forward. */
+static inline uint64_t BitOps_ReadU64L(const void *c) {
+	return BITOPS_READ_U64L(c);
+}
+
+/** Writing a 16-bit unsigned number with the highest byte forward. */
+static inline void BitOps_WriteU16B(void *c, uint16_t v) {
+	BITOPS_WRITE_U16B(c, v);
+}
+
+/** Writing a 16-bit unsigned number with the lowest byte forward. */
+static inline void BitOps_WriteU16L(void *c, uint16_t v) {
+	BITOPS_WRITE_U16L(c, v);
+}
+
+/** Writing a 32-bit unsigned number with the highest byte forward. */
+static inline void BitOps_WriteU32B(void *c, uint32_t v) {
+	BITOPS_WRITE_U32B(c, v);
+}
+
+/** Writing a 32-bit unsigned number with the lowest byte forward. */
+static inline void BitOps_WriteU32L(void *c, uint32_t v) {
+	BITOPS_WRITE_U32L(c, v);
+}
+
+/** Writing a 64-bit unsigned number with the highest byte forward. */
+static inline void BitOps_WriteU64B(void *c, uint64_t v) {
+	BITOPS_WRITE_U64B(c, v);
+}
+
+/** Writing a 64-bit unsigned number with the lowest byte forward. */
+static inline void BitOps_WriteU64L(void *c, uint64_t v) {
+	BITOPS_WRITE_U64L(c, v);
+}
+
+/** Reversing byte order of every element of an array in place.
+@param a : array
+@param n : number of elements */
+static inline void BitOps_BswapArray16(uint16_t *a, size_t n) {
+	for (size_t k = 0; k < n; k++) {
+		a[k] = BitOps_Bswap16(a[k]);
+	}
+}
+
+/** Reversing byte order of every element of an array in place.
+@param a : array
+@param n : number of elements */
+static inline void BitOps_BswapArray32(uint32_t *a, size_t n) {
+	for (size_t k = 0; k < n; k++) {
+		a[k] = BitOps_Bswap32(a[k]);
+	}
+}
+
+/** Reversing byte order of every element of an array in place.
+@param a : array
+@param n : number of elements */
+static inline void BitOps_BswapArray64(uint64_t *a, size_t n) {
+	for (size_t k = 0; k < n; k++) {
+		a[k] = BitOps_Bswap64(a[k]);
+	}
+}
+
+/** Reading an array of 16-bit unsigned numbers with the highest byte forward.
+@param dst : output array
+@param c : source bytes, 2 * n
+@param n : number of elements */
+static inline void BitOps_ReadArrayU16B(uint16_t *BITOPS_RESTRICT dst, const uint8_t *BITOPS_RESTRICT c, size_t n) {
+#if defined(BITOPS_LITTLE_ENDIAN)
+	memcpy(dst, c, n * 2);
+	BitOps_BswapArray16(dst, n);
+#elif defined(BITOPS_BIG_ENDIAN)
+	memcpy(dst, c, n * 2);
+#else
+	for (size_t k = 0; k < n; k++) {
+		dst[k] = (uint16_t)BITOPS_READ_U16B(c + 2 * k);
+	}
+#endif
+}
+
+/** Reading an array of 16-bit unsigned numbers with the lowest byte forward.
+@param dst : output array
+@param c : source bytes, 2 * n
+@param n : number of elements */
+static inline void BitOps_ReadArrayU16L(uint16_t *BITOPS_RESTRICT dst, const uint8_t *BITOPS_RESTRICT c, size_t n) {
+#if defined(BITOPS_BIG_ENDIAN)
+	memcpy(dst, c, n * 2);
+	BitOps_BswapArray16(dst, n);
+#elif defined(BITOPS_LITTLE_ENDIAN)
+	memcpy(dst, c, n * 2);
+#else
+	for (size_t k = 0; k < n; k++) {
+		dst[k] = (uint16_t)BITOPS_READ_U16L(c + 2 * k);
+	}
+#endif
+}
+
+/** Reading an array of 32-bit unsigned numbers with the highest byte forward.
+@param dst : output array
+@param c : source bytes, 4 * n
+@param n : number of elements */
+static inline void BitOps_ReadArrayU32B(uint32_t *BITOPS_RESTRICT dst, const uint8_t *BITOPS_RESTRICT c, size_t n) {
+#if defined(BITOPS_LITTLE_ENDIAN)
+	memcpy(dst, c, n * 4);
+	BitOps_BswapArray32(dst, n);
+#elif defined(BITOPS_BIG_ENDIAN)
+	memcpy(dst, c, n * 4);
+#else
+	for (size_t k = 0; k < n; k++) {
+		dst[k] = (uint32_t)BITOPS_READ_U32B(c + 4 * k);
+	}
+#endif
+}
+
+/** Reading an array of 32-bit unsigned numbers with the lowest byte forward.
+@param dst : output array
+@param c : source bytes, 4 * n
+@param n : number of elements */
+static inline void BitOps_ReadArrayU32L(uint32_t *BITOPS_RESTRICT dst, const uint8_t *BITOPS_RESTRICT c, size_t n) {
+#if defined(BITOPS_BIG_ENDIAN)
+	memcpy(dst, c, n * 4);
+	BitOps_BswapArray32(dst, n);
+#elif defined(BITOPS_LITTLE_ENDIAN)
+	memcpy(dst, c, n * 4);
+#else
+	for (size_t k = 0; k < n; k++) {
+		dst[k] = (uint32_t)BITOPS_READ_U32L(c + 4 * k);
+	}
+#endif
+}
+
+/** Reading an array of 64-bit unsigned numbers with the highest byte forward.
+@param dst : output array
+@param c : source bytes, 8 * n
+@param n : number of elements */
+static inline void BitOps_ReadArrayU64B(uint64_t *BITOPS_RESTRICT dst, const uint8_t *BITOPS_RESTRICT c, size_t n) {
+#if defined(BITOPS_LITTLE_ENDIAN)
+	memcpy(dst, c, n * 8);
+	BitOps_BswapArray64(dst, n);
+#elif defined(BITOPS_BIG_ENDIAN)
+	memcpy(dst, c, n * 8);
+#else
+	for (size_t k = 0; k < n; k++) {
+		dst[k] = (uint64_t)BITOPS_READ_U64B(c + 8 * k);
+	}
+#endif
+}
+
+/** Reading an array of 64-bit unsigned numbers with the lowest byte forward.
+@param dst : output array
+@param c : source bytes, 8 * n
+@param n : number of elements */
+static inline void BitOps_ReadArrayU64L(uint64_t *BITOPS_RESTRICT dst, const uint8_t *BITOPS_RESTRICT c, size_t n) {
+#if defined(BITOPS_BIG_ENDIAN)
+	memcpy(dst, c, n * 8);
+	BitOps_BswapArray64(dst, n);
+#elif defined(BITOPS_LITTLE_ENDIAN)
+	memcpy(dst, c, n * 8);
+#else
+	for (size_t k = 0; k < n; k++) {
+		dst[k] = (uint64_t)BITOPS_READ_U64L(c + 8 * k);
+	}
+#endif
+}
+
+/** Selecting the same bit field from every element of an array.
+@param dst : output array
+@param src : source array
+@param n : number of elements
+@param b1 : index of the first bit, starting from 0
+@param bn : number of bits, 1..8 */
+static inline void BitOps_GetBitsArray8(uint8_t *BITOPS_RESTRICT dst, const uint8_t *BITOPS_RESTRICT src, size_t n, unsigned b1, unsigned bn) {
+	const uint8_t mask = (uint8_t)BitOps_Mask32(bn);
+	for (size_t k = 0; k < n; k++) {
+		dst[k] = (uint8_t)((src[k] >> b1) & mask);
+	}
+}
+
+/** Selecting the same bit field from every element of an array.
+@param dst : output array
+@param src : source array
+@param n : number of elements
+@param b1 : index of the first bit, starting from 0
+@param bn : number of bits, 1..16 */
+static inline void BitOps_GetBitsArray16(uint16_t *BITOPS_RESTRICT dst, const uint16_t *BITOPS_RESTRICT src, size_t n, unsigned b1, unsigned bn) {
+	const uint16_t mask = (uint16_t)BitOps_Mask32(bn);
+	for (size_t k = 0; k < n; k++) {
+		dst[k] = (uint16_t)((src[k] >> b1) & mask);
+	}
+}
+
+/** Selecting the same bit field from every element of an array.
+@param dst : output array
+@param src : source array
+@param n : number of elements
+@param b1 : index of the first bit, starting from 0
+@param bn : number of bits, 1..32 */
+static inline void BitOps_GetBitsArray32(uint32_t *BITOPS_RESTRICT dst, const uint32_t *BITOPS_RESTRICT src, size_t n, unsigned b1, unsigned bn) {
+	const uint32_t mask = BitOps_Mask32(bn);
+	for (size_t k = 0; k < n; k++) {
+		dst[k] = (src[k] >> b1) & mask;
+	}
+}
+
+/** Selecting the same bit field from every element of an array (64-bit version).
+@param dst : output array
+@param src : source array
+@param n : number of elements
+@param b1 : index of the first bit, starting from 0
+@param bn : number of bits, 1..64 */
+static inline void BitOps_GetBitsArray64(uint64_t *BITOPS_RESTRICT dst, const uint64_t *BITOPS_RESTRICT src, size_t n, unsigned b1, unsigned bn) {
+	const uint64_t mask = BitOps_Mask64(bn);
+	for (size_t k = 0; k < n; k++) {
+		dst[k] = (src[k] >> b1) & mask;
+	}
+}
+
+
 #ifdef  __cplusplus
 }
 #endif
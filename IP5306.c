@@ -4,26 +4,464 @@
 #define I2C_READ_TIMEOUT_MS 5
 #define I2C_WRITE_WAIT_MS 5
 
-#define REG_SYS_CTL0_ADDR 0x00
-#define REG_SYS_CTL1_ADDR 0x01
-#define REG_SYS_CTL2_ADDR 0x02
-
-#define REG_CHARGER_CTL0_ADDR 0x20
-#define REG_CHARGER_CTL1_ADDR 0x21
-#define REG_CHARGER_CTL2_ADDR 0x22
-#define REG_CHARGER_CTL3_ADDR 0x23
-#define REG_CHG_DIG_CTL0_ADDR 0x24
-
-#define REG_READ0_ADDR 0x70
-#define REG_READ1_ADDR 0x71
-#define REG_READ2_ADDR 0x72
-#define REG_READ3_ADDR 0x77
-
 #define KEY_SHORT_PRESS_MS 30 // If the button is pressed for longer than 30ms but less than 2s, it is a short press.
 #define KEY_LONG_PRESS_MS 2000 // If the button is pressed for longer than 2 seconds, it is a long press
+#define KEY_PULSE_MS (4 * KEY_SHORT_PRESS_MS) // safety margin
+#define KEY_LONG_PULSE_MS (KEY_LONG_PRESS_MS + 500) // safety margin
+#define KEY_DOUBLE_PRESS_GAP_MS 100
+
+#define KEY_CALIBRATION_MIN_MS 10 // Lower bound of pulse width and gap search
+#define KEY_CALIBRATION_RESOLUTION_MS 2
+#define KEY_CALIBRATION_REPEATS 3 // Consecutive accepted trials needed to accept a value
+#define KEY_CALIBRATION_SETTLE_MS 50 // Time for the chip to register a short press
+#define KEY_CALIBRATION_MARGIN_PERCENT 50 // Safety margin added to the shortest accepted value
+#define KEY_CALIBRATION_POLL_MS 10
 
 #define MIN_STATE_CHANGE_PERIOD_MS 1000
+#define STATE_CHANGE_WINDOW_MS (MIN_STATE_CHANGE_PERIOD_MS + 500)
+
+#define WRITE_QUEUE_RETRY_MS 100
+#define WRITE_PLAN_RETRY_MS 100
+#define WRITE_PLAN_MAX_ATTEMPTS 3 // Persistent mismatch (e.g. a bit the chip does not keep) must not block the write queue
+
+#define BUS_DEFAULT_FAILURE_THRESHOLD 3
+#define BUS_DEFAULT_INITIAL_BACKOFF_MS 100
+#define BUS_DEFAULT_MAX_BACKOFF_MS 10000
+
+struct RegInfo {
+    uint8_t addr;
+    const char *name;
+    uint8_t fieldMask; // Bits written by the driver, other bits are kept as read from the chip
+};
+
+// In register address order, index n corresponds to the IP5306_*_BIT with value 1 << n
+static const struct RegInfo regInfos[IP5306_REG_COUNT] = {
+    { IP5306_REG_SYS_CTL0_ADDR, "SYS_CTL0", 0x37 },
+    { IP5306_REG_SYS_CTL1_ADDR, "SYS_CTL1", 0xe5 },
+    { IP5306_REG_SYS_CTL2_ADDR, "SYS_CTL2", 0x0c },
+    { IP5306_REG_CHARGER_CTL0_ADDR, "CHARGER_CTL0", 0x03 },
+    { IP5306_REG_CHARGER_CTL1_ADDR, "CHARGER_CTL1", 0xdc },
+    { IP5306_REG_CHARGER_CTL2_ADDR, "CHARGER_CTL2", 0x0f },
+    { IP5306_REG_CHARGER_CTL3_ADDR, "CHARGER_CTL3", 0x20 },
+    { IP5306_REG_CHG_DIG_CTL0_ADDR, "CHG_DIG_CTL0", 0x1f },
+    { IP5306_REG_READ0_ADDR, "READ0", 0x00 },
+    { IP5306_REG_READ1_ADDR, "READ1", 0x00 },
+    { IP5306_REG_READ2_ADDR, "READ2", 0x00 },
+    { IP5306_REG_READ3_ADDR, "READ3", 0x00 },
+    { IP5306_REG_READ4_ADDR, "READ4", 0x00 }
+};
+
+
+static uint16_t getKeyPulseMs(struct IP5306_Platform *platform) {
+    if (platform->keyTiming && platform->keyTiming->pulseMs > 0) {
+        return platform->keyTiming->pulseMs;
+    }
+
+    return KEY_PULSE_MS;
+}
+
+static uint16_t getKeyGapMs(struct IP5306_Platform *platform) {
+    if (platform->keyTiming && platform->keyTiming->gapMs > 0) {
+        return platform->keyTiming->gapMs;
+    }
+
+    return KEY_DOUBLE_PRESS_GAP_MS;
+}
+
+static void buildKeyGesture(struct IP5306_Platform *platform, enum IP5306_KeyGesture gesture, struct IP5306_KeyPulseTrain *train) {
+    switch (gesture) {
+    case IP5306_KeyGesture_DoublePress:
+        train->count = 2;
+        train->pulses[0].lowMs = getKeyPulseMs(platform);
+        train->pulses[0].highMs = getKeyGapMs(platform);
+        train->pulses[1].lowMs = getKeyPulseMs(platform);
+        train->pulses[1].highMs = 0;
+        break;
+
+    case IP5306_KeyGesture_LongPress:
+        train->count = 1;
+        train->pulses[0].lowMs = KEY_LONG_PULSE_MS;
+        train->pulses[0].highMs = 0;
+        break;
+
+    case IP5306_KeyGesture_ShortPress:
+    default:
+        train->count = 1;
+        train->pulses[0].lowMs = getKeyPulseMs(platform);
+        train->pulses[0].highMs = 0;
+        break;
+    }
+}
+
+static void sendKeyPulseTrainGpio(struct IP5306_Platform *platform, const struct IP5306_KeyPulseTrain *train) {
+    for (int i = 0; i < train->count; i++) {
+        platform->setKeyGpioMode(IP5306_GpioMode_PushPullOutput);
+        platform->setKeyGpioPin(0);
+        platform->delayMs(train->pulses[i].lowMs);
+        platform->setKeyGpioMode(IP5306_GpioMode_FloatingInput);
+
+        if (train->pulses[i].highMs > 0) {
+            platform->delayMs(train->pulses[i].highMs);
+        }
+    }
+}
+
+static int regAddrToIndex(uint8_t regAddr) {
+    for (int i = 0; i < IP5306_REG_COUNT; i++) {
+        if (regInfos[i].addr == regAddr) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static void countRegError(struct IP5306_Platform *platform, uint8_t regAddr) {
+    int index = regAddrToIndex(regAddr);
+    if (platform->stats && index >= 0) {
+        platform->stats->regErrors[index]++;
+    }
+}
+
+static uint32_t beginOp(struct IP5306_Platform *platform) {
+    return platform->stats ? platform->getCycleTime() : platform->invalidCycleTimeValue;
+}
+
+static void endOp(struct IP5306_Platform *platform, enum IP5306_Op op, uint32_t startCycleTime, bool ok) {
+    if (!platform->stats) {
+        return;
+    }
+
+    struct IP5306_OpStats *opStats = &platform->stats->ops[op];
+    int32_t latency = platform->getTimeDiffMs(platform->getCycleTime(), startCycleTime);
+
+    int bucket = 0;
+    while (bucket < IP5306_LATENCY_BUCKETS - 1 && latency >= (1 << bucket)) {
+        bucket++;
+    }
+
+    opStats->calls++;
+    if (!ok) {
+        opStats->errors++;
+    }
+    if (latency > opStats->maxLatencyMs) {
+        opStats->maxLatencyMs = latency;
+    }
+    opStats->latencyHistogram[bucket]++;
+}
+
+// Accounts time spent in the current state up to cycleTime, must be called before every state change
+static void accountState(struct IP5306_Platform *platform, uint32_t cycleTime) {
+    struct IP5306_Stats *stats = platform->stats;
+    if (!stats) {
+        return;
+    }
+
+    if (stats->stateCycleTime != platform->invalidCycleTimeValue) {
+        int32_t elapsed = platform->getTimeDiffMs(cycleTime, stats->stateCycleTime);
+        if (elapsed < 0) {
+            // Older time, residency is already accounted past it
+            return;
+        }
+
+        stats->stateResidencyMs[platform->state] += (uint32_t)elapsed;
+    }
+
+    stats->stateCycleTime = cycleTime;
+}
+
+static void countStateEntry(struct IP5306_Platform *platform) {
+    if (platform->stats) {
+        platform->stats->stateEntries[platform->state]++;
+    }
+}
+
+// Chip may have lost its configuration while sleeping, replay the write plan once it is working again
+static void armWritePlan(struct IP5306_Platform *platform, enum IP5306_State prevState) {
+    if (platform->writePlan && platform->state == IP5306_State_Working &&
+            (prevState == IP5306_State_Sleep || prevState == IP5306_State_WakingUp)) {
+        platform->writePlan->pending = true;
+        platform->writePlan->attempts = 0;
+    }
+}
+
+// State change made by the driver itself (key gesture), transient states open the state change window
+static void changeState(struct IP5306_Platform *platform, enum IP5306_State state) {
+    enum IP5306_State prevState = platform->state;
+    uint32_t cycleTime = platform->getCycleTime();
+    accountState(platform, cycleTime);
+
+    platform->state = state;
+    platform->lastStateChangeCycleTime = (state == IP5306_State_WakingUp || state == IP5306_State_ShuttingDown) ?
+        cycleTime : platform->invalidCycleTimeValue;
+    countStateEntry(platform);
+    armWritePlan(platform, prevState);
+}
+
+static bool isBusScheduled(struct IP5306_Platform *platform) {
+    return platform->scheduleReadReg && platform->scheduleWriteReg;
+}
+
+static bool isBusAllowed(struct IP5306_Platform *platform, uint8_t regAddr, const char *regName) {
+    struct IP5306_BusHealth *health = platform->busHealth;
+    if (!health || health->state == IP5306_BusHealthState_Closed) {
+        return true;
+    }
+
+    // Probe the bus once backoff is over, other transfers are rejected until the probe result is known
+    if (health->state == IP5306_BusHealthState_Open &&
+            platform->getTimeDiffMs(platform->getCycleTime(), health->trippedCycleTime) >= health->backoffMs) {
+        health->state = IP5306_BusHealthState_HalfOpen;
+        return true;
+    }
+
+    health->rejected++;
+    platform->debugPrint("IP5306: %s transfer rejected, bus is failing\r\n", regName);
+    countRegError(platform, regAddr);
+
+    return false;
+}
+
+static void tripBus(struct IP5306_Platform *platform) {
+    struct IP5306_BusHealth *health = platform->busHealth;
+
+    health->state = IP5306_BusHealthState_Open;
+    health->trippedCycleTime = platform->getCycleTime();
+
+    if (platform->recoverBus) {
+        platform->recoverBus();
+        health->recoveryAttempts++;
+    }
+}
+
+static uint32_t beginTransfer(struct IP5306_Platform *platform) {
+    return platform->busHealth ? platform->getCycleTime() : platform->invalidCycleTimeValue;
+}
+
+static bool isTimeout(struct IP5306_Platform *platform, int ret, uint32_t startCycleTime) {
+    struct IP5306_BusHealth *health = platform->busHealth;
+
+    if (health->timeoutResult != 0 && ret == health->timeoutResult) {
+        return true;
+    }
+
+    // Scheduled transfer time includes queueing, so only the result can tell
+    if (isBusScheduled(platform)) {
+        return false;
+    }
+
+    return platform->getTimeDiffMs(platform->getCycleTime(), startCycleTime) >= I2C_READ_TIMEOUT_MS;
+}
 
+static void updateBusHealth(struct IP5306_Platform *platform, int ret, uint32_t startCycleTime) {
+    struct IP5306_BusHealth *health = platform->busHealth;
+    if (!health) {
+        return;
+    }
+
+    if (ret >= 0) {
+        if (health->state != IP5306_BusHealthState_Closed) {
+            platform->debugPrint("IP5306: Bus recovered\r\n");
+        }
+
+        health->state = IP5306_BusHealthState_Closed;
+        health->consecutiveFailures = 0;
+        health->consecutiveTimeouts = 0;
+        health->backoffMs = health->initialBackoffMs;
+        return;
+    }
+
+    bool timeout = isTimeout(platform, ret, startCycleTime);
+    if (timeout) {
+        health->timeouts++;
+        health->consecutiveTimeouts++;
+    } else {
+        health->errors++;
+        health->consecutiveTimeouts = 0;
+    }
+    health->consecutiveFailures++;
+
+    if (health->state == IP5306_BusHealthState_HalfOpen) {
+        // Probe failed, wait longer before the next one
+        health->backoffMs = health->backoffMs * 2 > health->maxBackoffMs ? health->maxBackoffMs : health->backoffMs * 2;
+        tripBus(platform);
+    } else if (health->state == IP5306_BusHealthState_Closed &&
+            (health->consecutiveFailures >= health->failureThreshold ||
+            (health->timeoutThreshold > 0 && health->consecutiveTimeouts >= health->timeoutThreshold))) {
+        platform->debugPrint("IP5306: Bus failing, %d consecutive errors (%d timeouts)\r\n",
+            health->consecutiveFailures, health->consecutiveTimeouts);
+
+        health->backoffMs = health->initialBackoffMs;
+        health->trips++;
+        tripBus(platform);
+    }
+}
+
+static bool readRegs(struct IP5306_Platform *platform, uint8_t regAddr, const char *regName, uint8_t *data, uint8_t length) {
+    if (!isBusAllowed(platform, regAddr, regName)) {
+        return false;
+    }
+
+    uint32_t startCycleTime = beginTransfer(platform);
+    int ret = isBusScheduled(platform) ?
+        platform->scheduleReadReg(regAddr, data, length, I2C_READ_TIMEOUT_MS) :
+        platform->i2cReadReg(IP5306_I2C_ADDR, regAddr, data, length, I2C_READ_TIMEOUT_MS);
+    updateBusHealth(platform, ret, startCycleTime);
+    if (ret < 0) {
+        platform->debugPrint("IP5306: Failed to read %s register: %d\r\n", regName, -ret);
+        countRegError(platform, regAddr);
+        return false;
+    }
+
+    return true;
+}
+
+static bool readReg(struct IP5306_Platform *platform, uint8_t regAddr, const char *regName, uint8_t *data) {
+    return readRegs(platform, regAddr, regName, data, 1);
+}
+
+static bool isWriteDeferred(struct IP5306_Platform *platform) {
+    return platform->writeQueue && platform->state != IP5306_State_Working && platform->state != IP5306_State_Unknown;
+}
+
+// Only the driver's fields are queued, the rest of the register is taken from the chip when the queue is flushed
+static bool queueWrite(struct IP5306_Platform *platform, uint8_t regAddr, const char *regName, uint8_t data) {
+    struct IP5306_WriteQueue *queue = platform->writeQueue;
+
+    int index = regAddrToIndex(regAddr);
+    if (index < 0 || index >= IP5306_WRITE_QUEUE_SIZE) {
+        return false;
+    }
+
+    uint8_t mask = regInfos[index].fieldMask;
+
+    if (queue->pendingRegBits & (1u << index)) {
+        queue->coalesced++;
+    }
+
+    queue->value[index] = (uint8_t)((queue->value[index] & ~mask) | (data & mask));
+    queue->mask[index] |= mask;
+    queue->pendingRegBits |= 1u << index;
+    queue->queued++;
+
+    platform->debugPrint("IP5306: %s write deferred until working\r\n", regName);
+
+    return true;
+}
+
+static bool sendWriteRegs(struct IP5306_Platform *platform, uint8_t regAddr, const char *regName, const uint8_t *data, uint8_t length) {
+    if (!isBusAllowed(platform, regAddr, regName)) {
+        return false;
+    }
+
+    uint32_t startCycleTime = beginTransfer(platform);
+    // Scheduler keeps the settle time as a gap for other devices, otherwise it is a blocking wait
+    int ret = isBusScheduled(platform) ?
+        platform->scheduleWriteReg(regAddr, data, length, I2C_WRITE_WAIT_MS) :
+        platform->i2cWriteReg(IP5306_I2C_ADDR, regAddr, data, length, I2C_WRITE_WAIT_MS);
+    updateBusHealth(platform, ret, startCycleTime);
+    if (ret < 0) {
+        platform->debugPrint("IP5306: Failed to write %s register: %d\r\n", regName, -ret);
+        countRegError(platform, regAddr);
+        return false;
+    }
+
+    return true;
+}
+
+static bool sendWriteReg(struct IP5306_Platform *platform, uint8_t regAddr, const char *regName, uint8_t data) {
+    return sendWriteRegs(platform, regAddr, regName, &data, 1);
+}
+
+// Configuration writes are queued while the chip cannot accept them, other writes go to the bus
+static bool writeReg(struct IP5306_Platform *platform, uint8_t regAddr, const char *regName, uint8_t data) {
+    if (isWriteDeferred(platform) && queueWrite(platform, regAddr, regName, data)) {
+        return true;
+    }
+
+    return sendWriteReg(platform, regAddr, regName, data);
+}
+
+static void flushWriteQueue(struct IP5306_Platform *platform) {
+    struct IP5306_WriteQueue *queue = platform->writeQueue;
+
+    for (int i = 0; i < IP5306_WRITE_QUEUE_SIZE && queue->pendingRegBits; i++) {
+        if (!(queue->pendingRegBits & (1u << i))) {
+            continue;
+        }
+
+        // Read-modify-write, so bits the driver does not own keep their current value
+        // Keep the rest queued and retry on a later step
+        uint8_t data;
+        if (!readReg(platform, regInfos[i].addr, regInfos[i].name, &data)) {
+            return;
+        }
+
+        data = (uint8_t)((data & ~queue->mask[i]) | queue->value[i]);
+
+        if (!sendWriteReg(platform, regInfos[i].addr, regInfos[i].name, data)) {
+            return;
+        }
+
+        queue->pendingRegBits &= ~(1u << i);
+        queue->value[i] = 0;
+        queue->mask[i] = 0;
+        queue->flushed++;
+    }
+}
+
+// Burst writes every range and verifies it with a burst read-back
+static bool applyWritePlan(struct IP5306_Platform *platform) {
+    struct IP5306_WritePlan *plan = platform->writePlan;
+
+    for (int i = 0; i < plan->rangeCount; i++) {
+        const struct IP5306_WritePlanRange *range = &plan->ranges[i];
+        const char *regName = regInfos[regAddrToIndex(range->regAddr)].name;
+
+        if (!sendWriteRegs(platform, range->regAddr, regName, range->data, range->length)) {
+            return false;
+        }
+
+        uint8_t readBack[IP5306_WRITE_PLAN_MAX_RANGE_LENGTH];
+        if (!readRegs(platform, range->regAddr, regName, readBack, range->length)) {
+            return false;
+        }
+
+        for (int j = 0; j < range->length; j++) {
+            if (readBack[j] != range->data[j]) {
+                platform->debugPrint("IP5306: Write plan verify failed at %s+%d: 0x%02X != 0x%02X\r\n",
+                    regName, j, readBack[j], range->data[j]);
+                countRegError(platform, (uint8_t)(range->regAddr + j));
+                plan->verifyFailures++;
+                return false;
+            }
+        }
+    }
+
+    plan->replays++;
+
+    return true;
+}
+
+static bool replayWritePlan(struct IP5306_Platform *platform) {
+    struct IP5306_WritePlan *plan = platform->writePlan;
+
+    if (applyWritePlan(platform)) {
+        plan->pending = false;
+        plan->attempts = 0;
+        return true;
+    }
+
+    plan->attempts++;
+    plan->pending = plan->attempts < WRITE_PLAN_MAX_ATTEMPTS;
+    if (!plan->pending) {
+        plan->attempts = 0;
+        plan->failures++;
+        platform->debugPrint("IP5306: Write plan failed after %d attempts\r\n", WRITE_PLAN_MAX_ATTEMPTS);
+    }
+
+    return false;
+}
 
 bool IP5306_Init(struct IP5306_Platform *platform) {
     platform->setKeyGpioMode(IP5306_GpioMode_FloatingInput);
@@ -31,16 +469,35 @@ bool IP5306_Init(struct IP5306_Platform *platform) {
     platform->state = IP5306_State_Unknown;
     platform->lastStateChangeCycleTime = platform->invalidCycleTimeValue;
 
+    if (platform->stats) {
+        IP5306_ResetStats(platform);
+    }
+
+    if (platform->busHealth) {
+        IP5306_ResetBusHealth(platform);
+    }
+
+    if (platform->writeQueue) {
+        IP5306_ClearWriteQueue(platform);
+    }
+
+    if (platform->writePlan) {
+        platform->writePlan->pending = false;
+        platform->writePlan->attempts = 0;
+    }
+
     return true;
 }
 
 void IP5306_Step(struct IP5306_Platform *platform, uint32_t cycleTime) {
     enum IP5306_State prevState = platform->state;
 
+    accountState(platform, cycleTime);
+
     // Check that enough time has passed since the last state change to avoid confusion press with double press
     bool stateChanging = (platform->state == IP5306_State_WakingUp || platform->state == IP5306_State_ShuttingDown) &&
         (platform->lastStateChangeCycleTime != platform->invalidCycleTimeValue &&
-        platform->getTimeDiffMs(cycleTime, platform->lastStateChangeCycleTime) < MIN_STATE_CHANGE_PERIOD_MS + 500);
+        platform->getTimeDiffMs(cycleTime, platform->lastStateChangeCycleTime) < STATE_CHANGE_WINDOW_MS);
     
     if (!stateChanging) {
         // Update state based on IRQ pin
@@ -65,10 +522,56 @@ void IP5306_Step(struct IP5306_Platform *platform, uint32_t cycleTime) {
     }
 
     if (platform->state != prevState) {
+        countStateEntry(platform);
         platform->debugPrint("IP5306: State changed from %d to %d\r\n", prevState, platform->state);
+        armWritePlan(platform, prevState);
+    }
+
+    if (!stateChanging && platform->state == IP5306_State_Working) {
+        if (platform->writePlan && platform->writePlan->pending) {
+            replayWritePlan(platform);
+        }
+
+        // Apply configuration written while the chip was not working, after the plan so it takes precedence
+        if (platform->writeQueue && platform->writeQueue->pendingRegBits) {
+            flushWriteQueue(platform);
+        }
     }
 }
 
+int32_t IP5306_GetNextStepDelayMs(struct IP5306_Platform *platform, uint32_t cycleTime) {
+    // State is not known yet, so IRQ pin must be sampled right away
+    if (platform->state == IP5306_State_Unknown) {
+        return 0;
+    }
+
+    // In transient states, step is required at the end of the state change window
+    if (platform->state == IP5306_State_WakingUp || platform->state == IP5306_State_ShuttingDown) {
+        if (platform->lastStateChangeCycleTime == platform->invalidCycleTimeValue) {
+            return 0;
+        }
+
+        int32_t elapsed = platform->getTimeDiffMs(cycleTime, platform->lastStateChangeCycleTime);
+        if (elapsed >= STATE_CHANGE_WINDOW_MS) {
+            return 0;
+        }
+
+        return STATE_CHANGE_WINDOW_MS - elapsed;
+    }
+
+    // Write plan or deferred writes failed to apply, retry later
+    if (platform->state == IP5306_State_Working && platform->writePlan && platform->writePlan->pending) {
+        return WRITE_PLAN_RETRY_MS;
+    }
+
+    if (platform->state == IP5306_State_Working && platform->writeQueue && platform->writeQueue->pendingRegBits) {
+        return WRITE_QUEUE_RETRY_MS;
+    }
+
+    // Sleep and Working states are idle, next step is only needed when IRQ pin changes
+    return IP5306_NO_STEP_DEADLINE;
+}
+
 enum IP5306_State IP5306_GetState(struct IP5306_Platform *platform) {
     return platform->state;
 }
@@ -77,60 +580,77 @@ bool IP5306_IsWorkingState(struct IP5306_Platform *platform) {
     return platform->state == IP5306_State_Working;
 }
 
-bool IP5306_WakeUp(struct IP5306_Platform *platform) {
+static bool wakeUp(struct IP5306_Platform *platform) {
     if (platform->state != IP5306_State_Sleep) {
         return false;
     }
 
     // A short press will turn on the power indicator and boost output.
-    platform->setKeyGpioMode(IP5306_GpioMode_PushPullOutput);
-    platform->setKeyGpioPin(0);
-    platform->delayMs(4 * KEY_SHORT_PRESS_MS);
-    platform->setKeyGpioMode(IP5306_GpioMode_FloatingInput);
+    IP5306_SendKeyGesture(platform, IP5306_KeyGesture_ShortPress);
 
-    platform->state = IP5306_State_WakingUp;
-    platform->lastStateChangeCycleTime = platform->getCycleTime();
+    changeState(platform, IP5306_State_WakingUp);
 
     platform->debugPrint("IP5306: Waking up key sent\r\n");
 
     return true;
 }
 
-bool IP5306_Shutdown(struct IP5306_Platform *platform) {
+static bool shutdown(struct IP5306_Platform *platform) {
     if (platform->state != IP5306_State_Working) {
         return false;
     }
 
     // Pressing the button twice within 1 second will turn off the boost output, power display and lighting LED.
-    platform->setKeyGpioMode(IP5306_GpioMode_PushPullOutput);
-    platform->setKeyGpioPin(0);
-    platform->delayMs(4 * KEY_SHORT_PRESS_MS); // safety margin
-    platform->setKeyGpioMode(IP5306_GpioMode_FloatingInput);
+    IP5306_SendKeyGesture(platform, IP5306_KeyGesture_DoublePress);
 
-    platform->delayMs(100);
+    changeState(platform, IP5306_State_ShuttingDown);
 
-    platform->setKeyGpioMode(IP5306_GpioMode_PushPullOutput);
-    platform->setKeyGpioPin(0);
-    platform->delayMs(4 * KEY_SHORT_PRESS_MS); // safety margin
-    platform->setKeyGpioMode(IP5306_GpioMode_FloatingInput);
+    platform->debugPrint("IP5306: Shutdown key sent\r\n");
 
-    platform->state = IP5306_State_ShuttingDown;
-    platform->lastStateChangeCycleTime = platform->getCycleTime();
+    return true;
+}
 
-    platform->debugPrint("IP5306: Shutdown key sent\r\n");
+bool IP5306_SendShortPress(struct IP5306_Platform *platform) {
+    if (platform->state != IP5306_State_Working) {
+        return false;
+    }
+
+    // NOTE: Second short press within 1 second is a double press which shuts the boost down
+    IP5306_SendKeyGesture(platform, IP5306_KeyGesture_ShortPress);
+
+    platform->debugPrint("IP5306: Short press key sent\r\n");
 
     return true;
 }
 
-bool IP5306_ReadSystemControl(struct IP5306_Platform *platform, struct IP5306_SystemControl *systemControl, unsigned int regBits) {
-    int ret;
+bool IP5306_SendKeyGesture(struct IP5306_Platform *platform, enum IP5306_KeyGesture gesture) {
+    struct IP5306_KeyPulseTrain train;
+    buildKeyGesture(platform, gesture, &train);
+
+    return IP5306_SendKeyPulseTrain(platform, &train);
+}
+
+// NOTE: Pulse train does not change driver state, use IP5306_WakeUp and IP5306_Shutdown for that
+bool IP5306_SendKeyPulseTrain(struct IP5306_Platform *platform, const struct IP5306_KeyPulseTrain *train) {
+    if (train->count == 0 || train->count > IP5306_KEY_PULSE_TRAIN_MAX_PULSES) {
+        return false;
+    }
+
+    if (platform->sendKeyPulseTrain && platform->sendKeyPulseTrain(train)) {
+        return true;
+    }
+
+    sendKeyPulseTrainGpio(platform, train);
+
+    return true;
+}
+
+static bool readSystemControl(struct IP5306_Platform *platform, struct IP5306_SystemControl *systemControl, unsigned int regBits) {
     uint8_t data;
 
     // Read SYS_CTL0 register
     if (regBits & IP5306_SYS_CTL0_BIT) {
-        ret = platform->i2cReadReg(IP5306_I2C_ADDR, REG_SYS_CTL0_ADDR, &data, 1, I2C_READ_TIMEOUT_MS);
-        if (ret < 0) {
-            platform->debugPrint("IP5306: Failed to read SYS_CTL0 register: %d\r\n", -ret);
+        if (!readReg(platform, IP5306_REG_SYS_CTL0_ADDR, "SYS_CTL0", &data)) {
             return false;
         }
 
@@ -145,9 +665,7 @@ bool IP5306_ReadSystemControl(struct IP5306_Platform *platform, struct IP5306_Sy
 
     // Read SYS_CTL1 register
     if (regBits & IP5306_SYS_CTL1_BIT) {
-        ret = platform->i2cReadReg(IP5306_I2C_ADDR, REG_SYS_CTL1_ADDR, &data, 1, I2C_READ_TIMEOUT_MS);
-        if (ret < 0) {
-            platform->debugPrint("IP5306: Failed to read SYS_CTL1 register: %d\r\n", -ret);
+        if (!readReg(platform, IP5306_REG_SYS_CTL1_ADDR, "SYS_CTL1", &data)) {
             return false;
         }
 
@@ -162,9 +680,7 @@ bool IP5306_ReadSystemControl(struct IP5306_Platform *platform, struct IP5306_Sy
 
     // Read SYS_CTL2 register
     if (regBits & IP5306_SYS_CTL2_BIT) {
-        ret = platform->i2cReadReg(IP5306_I2C_ADDR, REG_SYS_CTL2_ADDR, &data, 1, I2C_READ_TIMEOUT_MS);
-        if (ret < 0) {
-            platform->debugPrint("IP5306: Failed to read SYS_CTL2 register: %d\r\n", -ret);
+        if (!readReg(platform, IP5306_REG_SYS_CTL2_ADDR, "SYS_CTL2", &data)) {
             return false;
         }
 
@@ -176,21 +692,44 @@ bool IP5306_ReadSystemControl(struct IP5306_Platform *platform, struct IP5306_Sy
     return true;
 }
 
-bool IP5306_WriteSystemControl(struct IP5306_Platform *platform, struct IP5306_SystemControl *systemControl, unsigned int regBits) {
-    int ret;
-    uint8_t data;
+static uint8_t encodeSystemControl(const struct IP5306_SystemControl *systemControl, uint8_t regAddr) {
+    uint8_t data = 0;
 
-    if (regBits & IP5306_SYS_CTL0_BIT) {
+    switch (regAddr) {
+    case IP5306_REG_SYS_CTL0_ADDR:
         data = systemControl->sysCtl0RegData;
         BITOPS_SET_BIT(&data, 5, systemControl->boostEnable);
         BITOPS_SET_BIT(&data, 4, systemControl->chargerEnable);
         BITOPS_SET_BIT(&data, 2, systemControl->autoPowerOn);
         BITOPS_SET_BIT(&data, 1, systemControl->outputNormallyOpen);
         BITOPS_SET_BIT(&data, 0, systemControl->keyShutdownEnable);
+        break;
+
+    case IP5306_REG_SYS_CTL1_ADDR:
+        data = systemControl->sysCtl1RegData;
+        BITOPS_SET_BIT(&data, 7, systemControl->disableBoostControl);
+        BITOPS_SET_BIT(&data, 6, systemControl->switchWLEDControl);
+        BITOPS_SET_BIT(&data, 5, systemControl->shortPressSwitchBoostEnable);
+        BITOPS_SET_BIT(&data, 2, systemControl->enableBoostAfterVINUnplug);
+        BITOPS_SET_BIT(&data, 0, systemControl->batlow3V0ShutdownEnable);
+        break;
+
+    case IP5306_REG_SYS_CTL2_ADDR:
+        data = systemControl->sysCtl2RegData;
+        BITOPS_SET_BITS(&data, 2, 2, systemControl->lightLoadShutdownTime);
+        break;
+    }
+
+    return data;
+}
+
+static bool writeSystemControl(struct IP5306_Platform *platform, struct IP5306_SystemControl *systemControl, unsigned int regBits) {
+    uint8_t data;
 
-        ret = platform->i2cWriteReg(IP5306_I2C_ADDR, REG_SYS_CTL0_ADDR, &data, 1, I2C_WRITE_WAIT_MS);
-        if (ret < 0) {
-            platform->debugPrint("IP5306: Failed to write SYS_CTL0 register: %d\r\n", -ret);
+    if (regBits & IP5306_SYS_CTL0_BIT) {
+        data = encodeSystemControl(systemControl, IP5306_REG_SYS_CTL0_ADDR);
+
+        if (!writeReg(platform, IP5306_REG_SYS_CTL0_ADDR, "SYS_CTL0", data)) {
             return false;
         }
 
@@ -198,16 +737,9 @@ bool IP5306_WriteSystemControl(struct IP5306_Platform *platform, struct IP5306_S
     }
 
     if (regBits & IP5306_SYS_CTL1_BIT) {
-        data = systemControl->sysCtl1RegData;
-        BITOPS_SET_BIT(&data, 7, systemControl->disableBoostControl);
-        BITOPS_SET_BIT(&data, 6, systemControl->switchWLEDControl);
-        BITOPS_SET_BIT(&data, 5, systemControl->shortPressSwitchBoostEnable);
-        BITOPS_SET_BIT(&data, 2, systemControl->enableBoostAfterVINUnplug);
-        BITOPS_SET_BIT(&data, 0, systemControl->batlow3V0ShutdownEnable);
+        data = encodeSystemControl(systemControl, IP5306_REG_SYS_CTL1_ADDR);
 
-        ret = platform->i2cWriteReg(IP5306_I2C_ADDR, REG_SYS_CTL1_ADDR, &data, 1, I2C_WRITE_WAIT_MS);
-        if (ret < 0) {
-            platform->debugPrint("IP5306: Failed to write SYS_CTL1 register: %d\r\n", -ret);
+        if (!writeReg(platform, IP5306_REG_SYS_CTL1_ADDR, "SYS_CTL1", data)) {
             return false;
         }
 
@@ -215,12 +747,9 @@ bool IP5306_WriteSystemControl(struct IP5306_Platform *platform, struct IP5306_S
     }
 
     if (regBits & IP5306_SYS_CTL2_BIT) {
-        data = systemControl->sysCtl2RegData;
-        BITOPS_SET_BITS(&data, 2, 2, systemControl->lightLoadShutdownTime);
+        data = encodeSystemControl(systemControl, IP5306_REG_SYS_CTL2_ADDR);
 
-        ret = platform->i2cWriteReg(IP5306_I2C_ADDR, REG_SYS_CTL2_ADDR, &data, 1, I2C_WRITE_WAIT_MS);
-        if (ret < 0) {
-            platform->debugPrint("IP5306: Failed to write SYS_CTL2 register: %d\r\n", -ret);
+        if (!writeReg(platform, IP5306_REG_SYS_CTL2_ADDR, "SYS_CTL2", data)) {
             return false;
         }
 
@@ -230,15 +759,12 @@ bool IP5306_WriteSystemControl(struct IP5306_Platform *platform, struct IP5306_S
     return true;
 }
 
-bool IP5306_ReadChargerControl(struct IP5306_Platform *platform, struct IP5306_ChargerControl *chargerControl, unsigned int regBits) {
-    int ret;
+static bool readChargerControl(struct IP5306_Platform *platform, struct IP5306_ChargerControl *chargerControl, unsigned int regBits) {
     uint8_t data;
 
     // Read Charger_CTL0 register
     if (regBits & IP5306_CHARGER_CTL0_BIT) {
-        ret = platform->i2cReadReg(IP5306_I2C_ADDR, REG_CHARGER_CTL0_ADDR, &data, 1, I2C_READ_TIMEOUT_MS);
-        if (ret < 0) {
-            platform->debugPrint("IP5306: Failed to read CHARGER_CTL0 register: %d\r\n", -ret);
+        if (!readReg(platform, IP5306_REG_CHARGER_CTL0_ADDR, "CHARGER_CTL0", &data)) {
             return false;
         }
 
@@ -249,9 +775,7 @@ bool IP5306_ReadChargerControl(struct IP5306_Platform *platform, struct IP5306_C
 
     // Read Charger_CTL1 register
     if (regBits & IP5306_CHARGER_CTL1_BIT) {
-        ret = platform->i2cReadReg(IP5306_I2C_ADDR, REG_CHARGER_CTL1_ADDR, &data, 1, I2C_READ_TIMEOUT_MS);
-        if (ret < 0) {
-            platform->debugPrint("IP5306: Failed to read CHARGER_CTL1 register: %d\r\n", -ret);
+        if (!readReg(platform, IP5306_REG_CHARGER_CTL1_ADDR, "CHARGER_CTL1", &data)) {
             return false;
         }
 
@@ -263,9 +787,7 @@ bool IP5306_ReadChargerControl(struct IP5306_Platform *platform, struct IP5306_C
 
     // Read Charger_CTL2 register
     if (regBits & IP5306_CHARGER_CTL2_BIT) {
-        ret = platform->i2cReadReg(IP5306_I2C_ADDR, REG_CHARGER_CTL2_ADDR, &data, 1, I2C_READ_TIMEOUT_MS);
-        if (ret < 0) {
-            platform->debugPrint("IP5306: Failed to read CHARGER_CTL2 register: %d\r\n", -ret);
+        if (!readReg(platform, IP5306_REG_CHARGER_CTL2_ADDR, "CHARGER_CTL2", &data)) {
             return false;
         }
 
@@ -277,9 +799,7 @@ bool IP5306_ReadChargerControl(struct IP5306_Platform *platform, struct IP5306_C
 
     // Read Charger_CTL3 register
     if (regBits & IP5306_CHARGER_CTL3_BIT) {
-        ret = platform->i2cReadReg(IP5306_I2C_ADDR, REG_CHARGER_CTL3_ADDR, &data, 1, I2C_READ_TIMEOUT_MS);
-        if (ret < 0) {
-            platform->debugPrint("IP5306: Failed to read CHARGER_CTL3 register: %d\r\n", -ret);
+        if (!readReg(platform, IP5306_REG_CHARGER_CTL3_ADDR, "CHARGER_CTL3", &data)) {
             return false;
         }
 
@@ -290,9 +810,7 @@ bool IP5306_ReadChargerControl(struct IP5306_Platform *platform, struct IP5306_C
 
     // Read CHG_DIG_CTL0 register
     if (regBits & IP5306_CHG_DIG_CTL0_BIT) {
-        ret = platform->i2cReadReg(IP5306_I2C_ADDR, REG_CHG_DIG_CTL0_ADDR, &data, 1, I2C_READ_TIMEOUT_MS);
-        if (ret < 0) {
-            platform->debugPrint("IP5306: Failed to read CHG_DIG_CTL0 register: %d\r\n", -ret);
+        if (!readReg(platform, IP5306_REG_CHG_DIG_CTL0_ADDR, "CHG_DIG_CTL0", &data)) {
             return false;
         }
 
@@ -312,65 +830,33 @@ bool IP5306_ReadChargerControl(struct IP5306_Platform *platform, struct IP5306_C
     return true;
 }
 
-bool IP5306_WriteChargerControl(struct IP5306_Platform *platform, struct IP5306_ChargerControl *chargerControl, unsigned int regBits) {
-    int ret;
-    uint8_t data;
+static uint8_t encodeChargerControl(const struct IP5306_ChargerControl *chargerControl, uint8_t regAddr) {
+    uint8_t data = 0;
 
-    if (regBits & IP5306_CHARGER_CTL0_BIT) {
+    switch (regAddr) {
+    case IP5306_REG_CHARGER_CTL0_ADDR:
         data = chargerControl->chargerCtl0RegData;
         BITOPS_SET_BITS(&data, 0, 2, (uint8_t)chargerControl->chargerFullStop);
+        break;
 
-        ret = platform->i2cWriteReg(IP5306_I2C_ADDR, REG_CHARGER_CTL0_ADDR, &data, 1, I2C_WRITE_WAIT_MS);
-        if (ret < 0) {
-            platform->debugPrint("IP5306: Failed to write CHARGER_CTL0 register: %d\r\n", -ret);
-            return false;
-        }
-
-        chargerControl->chargerCtl0RegData = data;
-    }
-
-    if (regBits & IP5306_CHARGER_CTL1_BIT) {
+    case IP5306_REG_CHARGER_CTL1_ADDR:
         data = chargerControl->chargerCtl1RegData;
         BITOPS_SET_BITS(&data, 6, 2, (uint8_t)chargerControl->endCurrentDetection);
         BITOPS_SET_BITS(&data, 2, 3, (uint8_t)chargerControl->chargingUndervoltageLoop);
+        break;
 
-        ret = platform->i2cWriteReg(IP5306_I2C_ADDR, REG_CHARGER_CTL1_ADDR, &data, 1, I2C_WRITE_WAIT_MS);
-        if (ret < 0) {
-            platform->debugPrint("IP5306: Failed to write CHARGER_CTL1 register: %d\r\n", -ret);
-            return false;
-        }
-
-        chargerControl->chargerCtl1RegData = data;
-    }
-
-    if (regBits & IP5306_CHARGER_CTL2_BIT) {
+    case IP5306_REG_CHARGER_CTL2_ADDR:
         data = chargerControl->chargerCtl2RegData;
         BITOPS_SET_BITS(&data, 2, 2, (uint8_t)chargerControl->batteryVoltage);
         BITOPS_SET_BITS(&data, 0, 2, (uint8_t)chargerControl->constantVoltageCharging);
+        break;
 
-        ret = platform->i2cWriteReg(IP5306_I2C_ADDR, REG_CHARGER_CTL2_ADDR, &data, 1, I2C_WRITE_WAIT_MS);
-        if (ret < 0) {
-            platform->debugPrint("IP5306: Failed to write CHARGER_CTL2 register: %d\r\n", -ret);
-            return false;
-        }
-
-        chargerControl->chargerCtl2RegData = data;
-    }
-
-    if (regBits & IP5306_CHARGER_CTL3_BIT) {
+    case IP5306_REG_CHARGER_CTL3_ADDR:
         data = chargerControl->chargerCtl3RegData;
         BITOPS_SET_BIT(&data, 5, (uint8_t)chargerControl->chargingCurrentLoop);
+        break;
 
-        ret = platform->i2cWriteReg(IP5306_I2C_ADDR, REG_CHARGER_CTL3_ADDR, &data, 1, I2C_WRITE_WAIT_MS);
-        if (ret < 0) {
-            platform->debugPrint("IP5306: Failed to write CHARGER_CTL3 register: %d\r\n", -ret);
-            return false;
-        }
-
-        chargerControl->chargerCtl3RegData = data;
-    }
-
-    if (regBits & IP5306_CHG_DIG_CTL0_BIT) {
+    case IP5306_REG_CHG_DIG_CTL0_ADDR: {
         // Calculate polynomial coefficients from current value
         int current = chargerControl->chargingCurrent - 50;
         int b0, b1, b2, b3, b4;
@@ -410,17 +896,66 @@ bool IP5306_WriteChargerControl(struct IP5306_Platform *platform, struct IP5306_
             b0 = 0;
         }
 
-        // Write data
         data = chargerControl->chgDigCtl0RegData;
         BITOPS_SET_BIT(&data, 0, b0);
         BITOPS_SET_BIT(&data, 1, b1);
         BITOPS_SET_BIT(&data, 2, b2);
         BITOPS_SET_BIT(&data, 3, b3);
         BITOPS_SET_BIT(&data, 4, b4);
+        break;
+    }
+    }
+
+    return data;
+}
 
-        ret = platform->i2cWriteReg(IP5306_I2C_ADDR, REG_CHG_DIG_CTL0_ADDR, &data, 1, I2C_WRITE_WAIT_MS);
-        if (ret < 0) {
-            platform->debugPrint("IP5306: Failed to write CHG_DIG_CTL0 register: %d\r\n", -ret);
+static bool writeChargerControl(struct IP5306_Platform *platform, struct IP5306_ChargerControl *chargerControl, unsigned int regBits) {
+    uint8_t data;
+
+    if (regBits & IP5306_CHARGER_CTL0_BIT) {
+        data = encodeChargerControl(chargerControl, IP5306_REG_CHARGER_CTL0_ADDR);
+
+        if (!writeReg(platform, IP5306_REG_CHARGER_CTL0_ADDR, "CHARGER_CTL0", data)) {
+            return false;
+        }
+
+        chargerControl->chargerCtl0RegData = data;
+    }
+
+    if (regBits & IP5306_CHARGER_CTL1_BIT) {
+        data = encodeChargerControl(chargerControl, IP5306_REG_CHARGER_CTL1_ADDR);
+
+        if (!writeReg(platform, IP5306_REG_CHARGER_CTL1_ADDR, "CHARGER_CTL1", data)) {
+            return false;
+        }
+
+        chargerControl->chargerCtl1RegData = data;
+    }
+
+    if (regBits & IP5306_CHARGER_CTL2_BIT) {
+        data = encodeChargerControl(chargerControl, IP5306_REG_CHARGER_CTL2_ADDR);
+
+        if (!writeReg(platform, IP5306_REG_CHARGER_CTL2_ADDR, "CHARGER_CTL2", data)) {
+            return false;
+        }
+
+        chargerControl->chargerCtl2RegData = data;
+    }
+
+    if (regBits & IP5306_CHARGER_CTL3_BIT) {
+        data = encodeChargerControl(chargerControl, IP5306_REG_CHARGER_CTL3_ADDR);
+
+        if (!writeReg(platform, IP5306_REG_CHARGER_CTL3_ADDR, "CHARGER_CTL3", data)) {
+            return false;
+        }
+
+        chargerControl->chargerCtl3RegData = data;
+    }
+
+    if (regBits & IP5306_CHG_DIG_CTL0_BIT) {
+        data = encodeChargerControl(chargerControl, IP5306_REG_CHG_DIG_CTL0_ADDR);
+
+        if (!writeReg(platform, IP5306_REG_CHG_DIG_CTL0_ADDR, "CHG_DIG_CTL0", data)) {
             return false;
         }
 
@@ -430,14 +965,11 @@ bool IP5306_WriteChargerControl(struct IP5306_Platform *platform, struct IP5306_
     return true;
 }
 
-bool IP5306_ReadStatus(struct IP5306_Platform *platform, struct IP5306_Status *status, unsigned int regBits) {
-    int ret;
+static bool readStatus(struct IP5306_Platform *platform, struct IP5306_Status *status, unsigned int regBits) {
     uint8_t data;
 
     if (regBits & IP5306_READ0_BIT) {
-        ret = platform->i2cReadReg(IP5306_I2C_ADDR, REG_READ0_ADDR, &data, 1, I2C_READ_TIMEOUT_MS);
-        if (ret < 0) {
-            platform->debugPrint("IP5306: Failed to read READ0 register: %d\r\n", -ret);
+        if (!readReg(platform, IP5306_REG_READ0_ADDR, "READ0", &data)) {
             return false;
         }
 
@@ -447,9 +979,7 @@ bool IP5306_ReadStatus(struct IP5306_Platform *platform, struct IP5306_Status *s
     }
 
     if (regBits & IP5306_READ1_BIT) {
-        ret = platform->i2cReadReg(IP5306_I2C_ADDR, REG_READ1_ADDR, &data, 1, I2C_READ_TIMEOUT_MS);
-        if (ret < 0) {
-            platform->debugPrint("IP5306: Failed to read READ1 register: %d\r\n", -ret);
+        if (!readReg(platform, IP5306_REG_READ1_ADDR, "READ1", &data)) {
             return false;
         }
 
@@ -459,9 +989,7 @@ bool IP5306_ReadStatus(struct IP5306_Platform *platform, struct IP5306_Status *s
     }
 
     if (regBits & IP5306_READ2_BIT) {
-        ret = platform->i2cReadReg(IP5306_I2C_ADDR, REG_READ2_ADDR, &data, 1, I2C_READ_TIMEOUT_MS);
-        if (ret < 0) {
-            platform->debugPrint("IP5306: Failed to read READ2 register: %d\r\n", -ret);
+        if (!readReg(platform, IP5306_REG_READ2_ADDR, "READ2", &data)) {
             return false;
         }
 
@@ -471,9 +999,7 @@ bool IP5306_ReadStatus(struct IP5306_Platform *platform, struct IP5306_Status *s
     }
 
     if (regBits & IP5306_READ3_BIT) {
-        ret = platform->i2cReadReg(IP5306_I2C_ADDR, REG_READ3_ADDR, &data, 1, I2C_READ_TIMEOUT_MS);
-        if (ret < 0) {
-            platform->debugPrint("IP5306: Failed to read READ3 register: %d\r\n", -ret);
+        if (!readReg(platform, IP5306_REG_READ3_ADDR, "READ3", &data)) {
             return false;
         }
 
@@ -484,11 +1010,19 @@ bool IP5306_ReadStatus(struct IP5306_Platform *platform, struct IP5306_Status *s
         status->read3RegData = data;
     }
 
+    if (regBits & IP5306_READ4_BIT) {
+        if (!readReg(platform, IP5306_REG_READ4_ADDR, "READ4", &data)) {
+            return false;
+        }
+
+        status->batteryLevel = IP5306_DecodeBatteryLevel(data);
+        status->read4RegData = data;
+    }
+
     return true;
 }
 
-bool IP5306_WriteStatus(struct IP5306_Platform *platform, struct IP5306_Status *status) {
-    int ret;
+static bool writeStatus(struct IP5306_Platform *platform, struct IP5306_Status *status) {
     uint8_t data;
 
     // Prepare data (READ3 register only)
@@ -506,9 +1040,7 @@ bool IP5306_WriteStatus(struct IP5306_Platform *platform, struct IP5306_Status *
     }
 
     // Write data (READ3 register only)
-    ret = platform->i2cWriteReg(IP5306_I2C_ADDR, REG_READ3_ADDR, &data, 1, I2C_WRITE_WAIT_MS);
-    if (ret < 0) {
-        platform->debugPrint("IP5306: Failed to write READ3 register: %d\r\n", -ret);
+    if (!writeReg(platform, IP5306_REG_READ3_ADDR, "READ3", data)) {
         return false;
     }
 
@@ -516,3 +1048,413 @@ bool IP5306_WriteStatus(struct IP5306_Platform *platform, struct IP5306_Status *
 
     return true;
 }
+
+bool IP5306_ReadSystemControl(struct IP5306_Platform *platform, struct IP5306_SystemControl *systemControl, unsigned int regBits) {
+    uint32_t startCycleTime = beginOp(platform);
+    bool ok = readSystemControl(platform, systemControl, regBits);
+    endOp(platform, IP5306_Op_ReadSystemControl, startCycleTime, ok);
+
+    return ok;
+}
+
+bool IP5306_WriteSystemControl(struct IP5306_Platform *platform, struct IP5306_SystemControl *systemControl, unsigned int regBits) {
+    uint32_t startCycleTime = beginOp(platform);
+    bool ok = writeSystemControl(platform, systemControl, regBits);
+    endOp(platform, IP5306_Op_WriteSystemControl, startCycleTime, ok);
+
+    return ok;
+}
+
+bool IP5306_ReadChargerControl(struct IP5306_Platform *platform, struct IP5306_ChargerControl *chargerControl, unsigned int regBits) {
+    uint32_t startCycleTime = beginOp(platform);
+    bool ok = readChargerControl(platform, chargerControl, regBits);
+    endOp(platform, IP5306_Op_ReadChargerControl, startCycleTime, ok);
+
+    return ok;
+}
+
+bool IP5306_WriteChargerControl(struct IP5306_Platform *platform, struct IP5306_ChargerControl *chargerControl, unsigned int regBits) {
+    uint32_t startCycleTime = beginOp(platform);
+    bool ok = writeChargerControl(platform, chargerControl, regBits);
+    endOp(platform, IP5306_Op_WriteChargerControl, startCycleTime, ok);
+
+    return ok;
+}
+
+bool IP5306_ReadStatus(struct IP5306_Platform *platform, struct IP5306_Status *status, unsigned int regBits) {
+    uint32_t startCycleTime = beginOp(platform);
+    bool ok = readStatus(platform, status, regBits);
+    endOp(platform, IP5306_Op_ReadStatus, startCycleTime, ok);
+
+    return ok;
+}
+
+bool IP5306_WriteStatus(struct IP5306_Platform *platform, struct IP5306_Status *status) {
+    uint32_t startCycleTime = beginOp(platform);
+    bool ok = writeStatus(platform, status);
+    endOp(platform, IP5306_Op_WriteStatus, startCycleTime, ok);
+
+    return ok;
+}
+
+bool IP5306_WakeUp(struct IP5306_Platform *platform) {
+    uint32_t startCycleTime = beginOp(platform);
+    bool ok = wakeUp(platform);
+    endOp(platform, IP5306_Op_WakeUp, startCycleTime, ok);
+
+    return ok;
+}
+
+bool IP5306_Shutdown(struct IP5306_Platform *platform) {
+    uint32_t startCycleTime = beginOp(platform);
+    bool ok = shutdown(platform);
+    endOp(platform, IP5306_Op_Shutdown, startCycleTime, ok);
+
+    return ok;
+}
+
+void IP5306_ResetStats(struct IP5306_Platform *platform) {
+    struct IP5306_Stats *stats = platform->stats;
+    if (!stats) {
+        return;
+    }
+
+    for (int i = 0; i < IP5306_Op_Count; i++) {
+        stats->ops[i].calls = 0;
+        stats->ops[i].errors = 0;
+        stats->ops[i].maxLatencyMs = 0;
+        for (int j = 0; j < IP5306_LATENCY_BUCKETS; j++) {
+            stats->ops[i].latencyHistogram[j] = 0;
+        }
+    }
+
+    for (int i = 0; i < IP5306_REG_COUNT; i++) {
+        stats->regErrors[i] = 0;
+    }
+
+    for (int i = 0; i < IP5306_STATE_COUNT; i++) {
+        stats->stateResidencyMs[i] = 0;
+        stats->stateEntries[i] = 0;
+    }
+
+    stats->stateCycleTime = platform->invalidCycleTimeValue;
+}
+
+void IP5306_UpdateStats(struct IP5306_Platform *platform, uint32_t cycleTime) {
+    accountState(platform, cycleTime);
+}
+
+void IP5306_ResetBusHealth(struct IP5306_Platform *platform) {
+    struct IP5306_BusHealth *health = platform->busHealth;
+    if (!health) {
+        return;
+    }
+
+    // Zero threshold would trip on every failure, zero backoff would probe on every transfer
+    if (health->failureThreshold <= 0) {
+        health->failureThreshold = BUS_DEFAULT_FAILURE_THRESHOLD;
+    }
+    if (health->timeoutThreshold < 0) {
+        health->timeoutThreshold = 0;
+    }
+    if (health->initialBackoffMs <= 0) {
+        health->initialBackoffMs = BUS_DEFAULT_INITIAL_BACKOFF_MS;
+    }
+    if (health->maxBackoffMs <= 0) {
+        health->maxBackoffMs = BUS_DEFAULT_MAX_BACKOFF_MS;
+    }
+    if (health->maxBackoffMs < health->initialBackoffMs) {
+        health->maxBackoffMs = health->initialBackoffMs;
+    }
+
+    health->state = IP5306_BusHealthState_Closed;
+    health->consecutiveFailures = 0;
+    health->consecutiveTimeouts = 0;
+    health->backoffMs = health->initialBackoffMs;
+    health->trippedCycleTime = platform->invalidCycleTimeValue;
+    health->trips = 0;
+    health->recoveryAttempts = 0;
+    health->rejected = 0;
+    health->timeouts = 0;
+    health->errors = 0;
+}
+
+void IP5306_ClearWriteQueue(struct IP5306_Platform *platform) {
+    struct IP5306_WriteQueue *queue = platform->writeQueue;
+    if (!queue) {
+        return;
+    }
+
+    queue->pendingRegBits = 0;
+    for (int i = 0; i < IP5306_WRITE_QUEUE_SIZE; i++) {
+        queue->value[i] = 0;
+        queue->mask[i] = 0;
+    }
+
+    queue->queued = 0;
+    queue->coalesced = 0;
+    queue->flushed = 0;
+}
+
+static bool clearKeyFlags(struct IP5306_Platform *platform) {
+    struct IP5306_Status status;
+    if (!readStatus(platform, &status, IP5306_READ3_BIT)) {
+        return false;
+    }
+
+    status.doubleClick = true;
+    status.longPress = true;
+    status.shortPress = true;
+
+    return writeStatus(platform, &status);
+}
+
+static bool waitIrqLevel(struct IP5306_Platform *platform, int level, int32_t timeoutMs) {
+    uint32_t startCycleTime = platform->getCycleTime();
+
+    while (platform->getIrqGpioPin() != level) {
+        if (platform->getTimeDiffMs(platform->getCycleTime(), startCycleTime) >= timeoutMs) {
+            return false;
+        }
+
+        platform->delayMs(KEY_CALIBRATION_POLL_MS);
+    }
+
+    return true;
+}
+
+// Returns 1 if the gesture was recognized, 0 if not, -1 on bus error or if the chip could not be woken up again
+static int tryKeyTiming(struct IP5306_Platform *platform, bool doublePress, uint16_t pulseMs, uint16_t gapMs) {
+    struct IP5306_KeyPulseTrain train;
+    train.count = doublePress ? 2 : 1;
+    train.pulses[0].lowMs = pulseMs;
+    train.pulses[0].highMs = doublePress ? gapMs : 0;
+    train.pulses[1].lowMs = pulseMs;
+    train.pulses[1].highMs = 0;
+
+    if (!clearKeyFlags(platform)) {
+        return -1;
+    }
+
+    IP5306_SendKeyPulseTrain(platform, &train);
+
+    if (!doublePress) {
+        platform->delayMs(KEY_CALIBRATION_SETTLE_MS);
+
+        struct IP5306_Status status;
+        if (!readStatus(platform, &status, IP5306_READ3_BIT)) {
+            return -1;
+        }
+
+        // Keep the next trial out of the double press window
+        platform->delayMs(MIN_STATE_CHANGE_PERIOD_MS);
+
+        return status.shortPress ? 1 : 0;
+    }
+
+    // Accepted double press shuts the boost down, IRQ goes low. The chip may stop answering on the bus,
+    // so READ3 double click flag is checked only when key shutdown is disabled and the chip keeps working.
+    if (!waitIrqLevel(platform, 0, STATE_CHANGE_WINDOW_MS)) {
+        struct IP5306_Status status;
+        if (!readStatus(platform, &status, IP5306_READ3_BIT)) {
+            return -1;
+        }
+
+        return status.doubleClick ? 1 : 0;
+    }
+
+    // State changes go through the same accounting as IP5306_Shutdown and IP5306_WakeUp
+    changeState(platform, IP5306_State_ShuttingDown);
+    changeState(platform, IP5306_State_Sleep);
+
+    // Wake the chip up again with the default pulse, outside the double press window
+    platform->delayMs(MIN_STATE_CHANGE_PERIOD_MS);
+
+    train.count = 1;
+    train.pulses[0].lowMs = KEY_PULSE_MS;
+    train.pulses[0].highMs = 0;
+    IP5306_SendKeyPulseTrain(platform, &train);
+    changeState(platform, IP5306_State_WakingUp);
+
+    if (!waitIrqLevel(platform, 1, STATE_CHANGE_WINDOW_MS)) {
+        platform->debugPrint("IP5306: Key calibration failed to wake up\r\n");
+        changeState(platform, IP5306_State_Sleep);
+        return -1;
+    }
+
+    changeState(platform, IP5306_State_Working);
+
+    return 1;
+}
+
+static int tryKeyTimingRepeated(struct IP5306_Platform *platform, bool doublePress, uint16_t pulseMs, uint16_t gapMs) {
+    for (int i = 0; i < KEY_CALIBRATION_REPEATS; i++) {
+        int result = tryKeyTiming(platform, doublePress, pulseMs, gapMs);
+        if (result <= 0) {
+            return result;
+        }
+    }
+
+    return 1;
+}
+
+// Binary search of the shortest accepted pulse width (gapMs == 0) or gap in [KEY_CALIBRATION_MIN_MS, maxMs],
+// maxMs must be accepted. Returns 0 on error.
+static uint16_t searchKeyTiming(struct IP5306_Platform *platform, bool doublePress, uint16_t pulseMs, uint16_t maxMs) {
+    int lo = KEY_CALIBRATION_MIN_MS - 1; // Assumed rejected
+    int hi = maxMs; // Accepted
+
+    while (hi - lo > KEY_CALIBRATION_RESOLUTION_MS) {
+        int mid = (lo + hi) / 2;
+
+        int result = doublePress
+            ? tryKeyTimingRepeated(platform, true, pulseMs, (uint16_t)mid)
+            : tryKeyTimingRepeated(platform, false, (uint16_t)mid, 0);
+        if (result < 0) {
+            return 0;
+        }
+
+        if (result) {
+            hi = mid;
+        } else {
+            lo = mid;
+        }
+    }
+
+    return (uint16_t)hi;
+}
+
+static uint16_t addKeyTimingMargin(uint16_t ms, uint16_t maxMs) {
+    int withMargin = ms + (ms * KEY_CALIBRATION_MARGIN_PERCENT + 99) / 100;
+
+    return (uint16_t)(withMargin < maxMs ? withMargin : maxMs);
+}
+
+static bool calibrateKeyTiming(struct IP5306_Platform *platform, struct IP5306_KeyTiming *timing) {
+    // Defaults must work, otherwise the search bounds are meaningless
+    if (tryKeyTimingRepeated(platform, false, KEY_PULSE_MS, 0) <= 0) {
+        platform->debugPrint("IP5306: Key calibration, default pulse not accepted\r\n");
+        return false;
+    }
+
+    uint16_t minPulseMs = searchKeyTiming(platform, false, 0, KEY_PULSE_MS);
+    if (minPulseMs == 0) {
+        return false;
+    }
+    uint16_t pulseMs = addKeyTimingMargin(minPulseMs, KEY_PULSE_MS);
+
+    if (tryKeyTimingRepeated(platform, true, pulseMs, KEY_DOUBLE_PRESS_GAP_MS) <= 0) {
+        platform->debugPrint("IP5306: Key calibration, default gap not accepted\r\n");
+        return false;
+    }
+
+    uint16_t minGapMs = searchKeyTiming(platform, true, pulseMs, KEY_DOUBLE_PRESS_GAP_MS);
+    if (minGapMs == 0) {
+        return false;
+    }
+    uint16_t gapMs = addKeyTimingMargin(minGapMs, KEY_DOUBLE_PRESS_GAP_MS);
+
+    timing->pulseMs = pulseMs;
+    timing->gapMs = gapMs;
+
+    platform->debugPrint("IP5306: Key timing calibrated, pulse %d (min %d) ms, gap %d (min %d) ms\r\n",
+        pulseMs, minPulseMs, gapMs, minGapMs);
+
+    return true;
+}
+
+// NOTE: Blocks for about a minute and toggles the boost output off and on several times, run once per board
+// (e.g. in production) and store the result. Chip must be in Working state. Short press boost switching
+// is disabled for the run, otherwise every trial pulse would toggle the boost output.
+bool IP5306_CalibrateKeyTiming(struct IP5306_Platform *platform, struct IP5306_KeyTiming *timing) {
+    if (platform->state != IP5306_State_Working) {
+        return false;
+    }
+
+    struct IP5306_SystemControl systemControl;
+    if (!readSystemControl(platform, &systemControl, IP5306_SYS_CTL1_BIT)) {
+        return false;
+    }
+
+    bool shortPressSwitchBoost = systemControl.shortPressSwitchBoostEnable;
+    if (shortPressSwitchBoost) {
+        systemControl.shortPressSwitchBoostEnable = false;
+        if (!writeSystemControl(platform, &systemControl, IP5306_SYS_CTL1_BIT)) {
+            return false;
+        }
+    }
+
+    bool ok = calibrateKeyTiming(platform, timing);
+
+    if (shortPressSwitchBoost) {
+        systemControl.shortPressSwitchBoostEnable = true;
+        if (platform->state != IP5306_State_Working || !writeSystemControl(platform, &systemControl, IP5306_SYS_CTL1_BIT)) {
+            platform->debugPrint("IP5306: Key calibration failed to restore short press boost switching\r\n");
+            return false;
+        }
+    }
+
+    return ok;
+}
+
+bool IP5306_CompileWritePlan(struct IP5306_WritePlan *plan, const struct IP5306_SystemControl *systemControl,
+        const struct IP5306_ChargerControl *chargerControl, unsigned int regBits) {
+    if (((regBits & IP5306_SYS_CTL_ALL_BITS) && !systemControl) ||
+            ((regBits & IP5306_CHARGER_CTL_ALL_BITS) && !chargerControl) ||
+            (regBits & ~(IP5306_SYS_CTL_ALL_BITS | IP5306_CHARGER_CTL_ALL_BITS))) {
+        return false;
+    }
+
+    plan->rangeCount = 0;
+    plan->pending = false;
+    plan->attempts = 0;
+    plan->replays = 0;
+    plan->verifyFailures = 0;
+    plan->failures = 0;
+
+    struct IP5306_WritePlanRange *range = 0;
+    for (int i = 0; i < IP5306_CONFIG_REG_COUNT; i++) {
+        if (!(regBits & (1u << i))) {
+            continue;
+        }
+
+        uint8_t regAddr = regInfos[i].addr;
+        uint8_t data = regAddr < IP5306_REG_CHARGER_CTL0_ADDR
+            ? encodeSystemControl(systemControl, regAddr)
+            : encodeChargerControl(chargerControl, regAddr);
+
+        // Extend the current burst while registers are adjacent
+        if (!range || range->regAddr + range->length != regAddr) {
+            range = &plan->ranges[plan->rangeCount++];
+            range->regAddr = regAddr;
+            range->length = 0;
+        }
+
+        range->data[range->length++] = data;
+    }
+
+    return true;
+}
+
+bool IP5306_ApplyWritePlan(struct IP5306_Platform *platform) {
+    if (!platform->writePlan || platform->state != IP5306_State_Working) {
+        return false;
+    }
+
+    return replayWritePlan(platform);
+}
+
+static const char *getRegName(uint8_t regAddr) {
+    int index = regAddrToIndex(regAddr);
+
+    return index >= 0 ? regInfos[index].name : "unknown";
+}
+
+// Raw register access for add-on modules, goes through bus health and statistics but is never deferred
+bool IP5306_ReadRegs(struct IP5306_Platform *platform, uint8_t regAddr, uint8_t *data, uint8_t length) {
+    return readRegs(platform, regAddr, getRegName(regAddr), data, length);
+}
+
+bool IP5306_WriteRegs(struct IP5306_Platform *platform, uint8_t regAddr, const uint8_t *data, uint8_t length) {
+    return sendWriteRegs(platform, regAddr, getRegName(regAddr), data, length);
+}
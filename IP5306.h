@@ -4,8 +4,28 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #define IP5306_I2C_ADDR (0xea >> 1)
 
+#define IP5306_REG_SYS_CTL0_ADDR 0x00
+#define IP5306_REG_SYS_CTL1_ADDR 0x01
+#define IP5306_REG_SYS_CTL2_ADDR 0x02
+
+#define IP5306_REG_CHARGER_CTL0_ADDR 0x20
+#define IP5306_REG_CHARGER_CTL1_ADDR 0x21
+#define IP5306_REG_CHARGER_CTL2_ADDR 0x22
+#define IP5306_REG_CHARGER_CTL3_ADDR 0x23
+#define IP5306_REG_CHG_DIG_CTL0_ADDR 0x24
+
+#define IP5306_REG_READ0_ADDR 0x70
+#define IP5306_REG_READ1_ADDR 0x71
+#define IP5306_REG_READ2_ADDR 0x72
+#define IP5306_REG_READ3_ADDR 0x77
+#define IP5306_REG_READ4_ADDR 0x78
+
 #define IP5306_SYS_CTL0_BIT 00001
 #define IP5306_SYS_CTL1_BIT 00002
 #define IP5306_SYS_CTL2_BIT 00004
@@ -22,11 +42,38 @@
 #define IP5306_READ1_BIT 01000
 #define IP5306_READ2_BIT 02000
 #define IP5306_READ3_BIT 04000
-#define IP5306_READ_ALL_BITS 07400
+#define IP5306_READ4_BIT 010000
+#define IP5306_READ_ALL_BITS 07400 // READ0..READ3
+#define IP5306_READ_ALL_WITH_LEVEL_BITS (IP5306_READ_ALL_BITS | IP5306_READ4_BIT) // READ0..READ4
+
+// Returned by IP5306_GetNextStepDelayMs when the driver does not need IP5306_Step until the IRQ pin changes
+#define IP5306_NO_STEP_DEADLINE (-1)
 
 // NOTE: datasheet says nothing but experiments show that during sleep, all registers are being read, but it always returns 0xeb
 #define IP5306_SLEEPING_ANY_REG_VALUE 0xeb
 
+// READ4 bits 4..7 mirror the LED indicator, one bit is set per unlit LED
+#define IP5306_BATTERY_LEVEL_100_CODE 0x0
+#define IP5306_BATTERY_LEVEL_75_CODE 0x8
+#define IP5306_BATTERY_LEVEL_50_CODE 0xc
+#define IP5306_BATTERY_LEVEL_25_CODE 0xe
+
+// Shared by IP5306_ReadStatus and the batch decoder, returns 0, 25, 50, 75 or 100 (%)
+static inline uint8_t IP5306_DecodeBatteryLevel(uint8_t read4RegData) {
+    switch (read4RegData >> 4) {
+    case IP5306_BATTERY_LEVEL_100_CODE:
+        return 100;
+    case IP5306_BATTERY_LEVEL_75_CODE:
+        return 75;
+    case IP5306_BATTERY_LEVEL_50_CODE:
+        return 50;
+    case IP5306_BATTERY_LEVEL_25_CODE:
+        return 25;
+    default:
+        return 0;
+    }
+}
+
 enum IP5306_DisableBoostControl {
     IP5306_DisableBoostControl_LongPress = 1,
     IP5306_DisableBoostControl_ShortPressTwice = 0
@@ -170,6 +217,35 @@ struct IP5306_Status {
     bool longPress; // KEY button long press symbol, write 1 to clear
     bool shortPress; // KEY button short press symbol, write 1 to clear
     uint8_t read3RegData; // Raw register data
+
+    // READ4
+    int batteryLevel; // Battery level as shown by the 4 LEDs (%): 0, 25, 50, 75 or 100
+    uint8_t read4RegData; // Raw register data
+};
+
+#define IP5306_KEY_PULSE_TRAIN_MAX_PULSES 4
+
+// Key is held low for lowMs, then released for highMs
+struct IP5306_KeyPulse {
+    uint16_t lowMs;
+    uint16_t highMs;
+};
+
+struct IP5306_KeyPulseTrain {
+    uint8_t count;
+    struct IP5306_KeyPulse pulses[IP5306_KEY_PULSE_TRAIN_MAX_PULSES];
+};
+
+// Key timing for short and double press gestures, zero fields fall back to the defaults
+struct IP5306_KeyTiming {
+    uint16_t pulseMs; // Short press pulse width; default 120
+    uint16_t gapMs; // Release time between double press pulses; default 100
+};
+
+enum IP5306_KeyGesture {
+    IP5306_KeyGesture_ShortPress, // Wake up, turn on power indicator
+    IP5306_KeyGesture_DoublePress, // Turn off boost output, power indicator and WLED
+    IP5306_KeyGesture_LongPress // Switch WLED (or boost, depending on SYS_CTL1)
 };
 
 enum IP5306_State {
@@ -180,6 +256,111 @@ enum IP5306_State {
     IP5306_State_ShuttingDown
 };
 
+#define IP5306_STATE_COUNT (IP5306_State_ShuttingDown + 1)
+#define IP5306_REG_COUNT 13 // SYS_CTL0..2, CHARGER_CTL0..3, CHG_DIG_CTL0, READ0..4
+#define IP5306_CONFIG_REG_COUNT 8 // SYS_CTL0..2, CHARGER_CTL0..3, CHG_DIG_CTL0, first in register address order
+#define IP5306_LATENCY_BUCKETS 12 // [0, 1), [1, 2), [2, 4), ... [512, 1024), [1024, inf) ms
+
+enum IP5306_Op {
+    IP5306_Op_ReadSystemControl,
+    IP5306_Op_WriteSystemControl,
+    IP5306_Op_ReadChargerControl,
+    IP5306_Op_WriteChargerControl,
+    IP5306_Op_ReadStatus,
+    IP5306_Op_WriteStatus,
+    IP5306_Op_WakeUp,
+    IP5306_Op_Shutdown,
+    IP5306_Op_Count
+};
+
+struct IP5306_OpStats {
+    uint32_t calls;
+    uint32_t errors;
+    int32_t maxLatencyMs;
+    uint32_t latencyHistogram[IP5306_LATENCY_BUCKETS]; // Log2 buckets of call duration
+};
+
+struct IP5306_Stats {
+    struct IP5306_OpStats ops[IP5306_Op_Count];
+    uint32_t regErrors[IP5306_REG_COUNT]; // Failed transfers per register, in register address order
+    uint64_t stateResidencyMs[IP5306_STATE_COUNT]; // Time spent in each state
+    uint32_t stateEntries[IP5306_STATE_COUNT]; // Number of times each state was entered
+    uint32_t stateCycleTime; // Time up to which residency is accounted
+};
+
+enum IP5306_BusHealthState {
+    IP5306_BusHealthState_Closed, // Bus is healthy, transfers go through
+    IP5306_BusHealthState_Open, // Bus is failing, transfers fail fast until backoff expires
+    IP5306_BusHealthState_HalfOpen // Backoff expired, one transfer probes the bus, others are rejected meanwhile
+};
+
+// NOTE: A failed transfer is a timeout when the platform returns timeoutResult or, without a scheduler, when it took
+// at least the read timeout; anything else (NACK, arbitration loss) is an error. Timeouts point to a stuck bus,
+// so they may trip the breaker sooner.
+struct IP5306_BusHealth {
+    // Configuration, zero failureThreshold and backoffs are replaced by defaults in IP5306_ResetBusHealth (called by IP5306_Init)
+    int failureThreshold; // Consecutive failures of any kind which trip the breaker
+    int timeoutThreshold; // Consecutive timeouts which trip the breaker, 0 to use failureThreshold only
+    int timeoutResult; // Platform result meaning timeout (e.g. -ETIMEDOUT), 0 to classify by duration only
+    int initialBackoffMs; // First probe delay after trip, doubled after every failed probe
+    int maxBackoffMs;
+
+    // State
+    enum IP5306_BusHealthState state;
+    int consecutiveFailures;
+    int consecutiveTimeouts;
+    int backoffMs;
+    uint32_t trippedCycleTime;
+
+    // Statistics
+    uint32_t trips; // Number of times the breaker was tripped
+    uint32_t recoveryAttempts; // Number of recoverBus calls
+    uint32_t rejected; // Transfers failed fast without touching the bus
+    uint32_t timeouts; // Failed transfers classified as timeout
+    uint32_t errors; // Other failed transfers
+};
+
+#define IP5306_WRITE_QUEUE_SIZE IP5306_CONFIG_REG_COUNT
+
+// Configuration writes issued while the chip is not working, applied by IP5306_Step once Working state is confirmed
+struct IP5306_WriteQueue {
+    unsigned int pendingRegBits; // IP5306_SYS_CTL*_BIT / IP5306_CHARGER_CTL*_BIT / IP5306_CHG_DIG_CTL0_BIT
+    // Field values and masks of written bits in register address order, merged into the register read at flush time
+    uint8_t value[IP5306_WRITE_QUEUE_SIZE];
+    uint8_t mask[IP5306_WRITE_QUEUE_SIZE];
+
+    // Statistics
+    uint32_t queued; // Writes put to the queue
+    uint32_t coalesced; // Queued writes replaced by a later write to the same register
+    uint32_t flushed; // Writes applied from the queue
+};
+
+#define IP5306_WRITE_PLAN_MAX_RANGES 5 // Worst case of alternating selected registers in SYS_CTL0..2 and CHARGER_CTL0..CHG_DIG_CTL0
+#define IP5306_WRITE_PLAN_MAX_RANGE_LENGTH 5
+
+struct IP5306_WritePlanRange {
+    uint8_t regAddr; // First register of the burst
+    uint8_t length;
+    uint8_t data[IP5306_WRITE_PLAN_MAX_RANGE_LENGTH];
+};
+
+// Configuration compiled once into burst writes, replayed by IP5306_Step whenever the chip wakes up
+struct IP5306_WritePlan {
+    uint8_t rangeCount;
+    struct IP5306_WritePlanRange ranges[IP5306_WRITE_PLAN_MAX_RANGES];
+
+    // State
+    bool pending; // Replay needed, retried by IP5306_Step until written and verified or out of attempts
+    uint8_t attempts; // Failed attempts of the pending replay
+
+    // Statistics
+    uint32_t replays; // Successful replays
+    uint32_t verifyFailures; // Read-back mismatches
+    uint32_t failures; // Replays given up after all attempts failed
+};
+
+// NOTE: Fields from sendKeyPulseTrain on are optional and appended over time; zero-initialize the whole struct
+// (e.g. static storage or memset) so that unused ones are NULL.
 struct IP5306_Platform {
     int (*i2cWriteReg)(uint8_t addr7bit, uint8_t regNum, const uint8_t *data, uint8_t length, uint8_t wait);
     int (*i2cReadReg)(uint8_t addr7bit, uint8_t regNum, uint8_t *data, uint8_t length, int timeout);
@@ -199,15 +380,48 @@ struct IP5306_Platform {
     
     enum IP5306_State state;
     uint32_t lastStateChangeCycleTime;
+
+    // Optional: generate the key pulse train with a timer/PWM peripheral, return false to fall back to GPIO bit-bang.
+    // Must block until the last pulse has ended: WakeUp/Shutdown start the state change window when it returns.
+    bool (*sendKeyPulseTrain)(const struct IP5306_KeyPulseTrain *train);
+
+    // Optional: instrumentation, collected only when set
+    struct IP5306_Stats *stats;
+
+    // Optional: circuit breaker for the bus, used only when set
+    struct IP5306_BusHealth *busHealth;
+
+    // Optional: recover stuck bus (e.g. clock SCL until SDA is released), called when the breaker trips or a probe fails
+    void (*recoverBus)(void);
+
+    // Optional: defer configuration writes while not working, used only when set
+    struct IP5306_WriteQueue *writeQueue;
+
+    // Optional: calibrated key timing (see IP5306_CalibrateKeyTiming), defaults are used when not set
+    const struct IP5306_KeyTiming *keyTiming;
+
+    // Optional: configuration replayed after every Sleep to Working transition, used only when set
+    struct IP5306_WritePlan *writePlan;
+
+    // Optional: run register transfers through a bus scheduler instead of i2cReadReg / i2cWriteReg, used only when
+    // both are set (e.g. wrappers of IP5306_BusSchedulerReadReg / IP5306_BusSchedulerWriteReg). Write returns once
+    // the data is on the bus; settleMs is kept by the scheduler as a gap other devices can use, not a blocking wait.
+    int (*scheduleReadReg)(uint8_t regNum, uint8_t *data, uint8_t length, int timeoutMs);
+    int (*scheduleWriteReg)(uint8_t regNum, const uint8_t *data, uint8_t length, int settleMs);
 };
 
 bool IP5306_Init(struct IP5306_Platform *platform);
 void IP5306_Step(struct IP5306_Platform *platform, uint32_t cycleTime);
+int32_t IP5306_GetNextStepDelayMs(struct IP5306_Platform *platform, uint32_t cycleTime);
 
 enum IP5306_State IP5306_GetState(struct IP5306_Platform *platform);
 bool IP5306_IsWorkingState(struct IP5306_Platform *platform);
 bool IP5306_WakeUp(struct IP5306_Platform *platform);
 bool IP5306_Shutdown(struct IP5306_Platform *platform);
+bool IP5306_SendShortPress(struct IP5306_Platform *platform);
+bool IP5306_SendKeyGesture(struct IP5306_Platform *platform, enum IP5306_KeyGesture gesture);
+bool IP5306_SendKeyPulseTrain(struct IP5306_Platform *platform, const struct IP5306_KeyPulseTrain *train);
+bool IP5306_CalibrateKeyTiming(struct IP5306_Platform *platform, struct IP5306_KeyTiming *timing);
 
 bool IP5306_ReadSystemControl(struct IP5306_Platform *platform, struct IP5306_SystemControl *systemControl, unsigned int regBits);
 bool IP5306_WriteSystemControl(struct IP5306_Platform *platform, struct IP5306_SystemControl *systemControl, unsigned int regBits);
@@ -218,5 +432,21 @@ bool IP5306_WriteChargerControl(struct IP5306_Platform *platform, struct IP5306_
 bool IP5306_ReadStatus(struct IP5306_Platform *platform, struct IP5306_Status *status, unsigned int regBits);
 bool IP5306_WriteStatus(struct IP5306_Platform *platform, struct IP5306_Status *status);
 
+bool IP5306_ReadRegs(struct IP5306_Platform *platform, uint8_t regAddr, uint8_t *data, uint8_t length);
+bool IP5306_WriteRegs(struct IP5306_Platform *platform, uint8_t regAddr, const uint8_t *data, uint8_t length);
+
+void IP5306_ResetStats(struct IP5306_Platform *platform);
+void IP5306_UpdateStats(struct IP5306_Platform *platform, uint32_t cycleTime); // Counts residency in the current state up to cycleTime
+void IP5306_ResetBusHealth(struct IP5306_Platform *platform);
+void IP5306_ClearWriteQueue(struct IP5306_Platform *platform);
+
+// systemControl / chargerControl may be NULL when none of their registers are selected in regBits
+bool IP5306_CompileWritePlan(struct IP5306_WritePlan *plan, const struct IP5306_SystemControl *systemControl,
+    const struct IP5306_ChargerControl *chargerControl, unsigned int regBits);
+bool IP5306_ApplyWritePlan(struct IP5306_Platform *platform);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif // IP5306_H
@@ -0,0 +1,194 @@
+#include "IP5306_Accounting.h"
+
+
+static void clearTotals(struct IP5306_AccountingTotals *totals) {
+    for (int i = 0; i < IP5306_STATE_COUNT; i++) {
+        totals->stateMs[i] = 0;
+    }
+
+    totals->chargingMs = 0;
+    totals->energyUj = 0;
+    totals->wakeUps = 0;
+    totals->shutdowns = 0;
+    totals->chargeSessions = 0;
+    totals->fullCharges = 0;
+}
+
+static void addStateTime(struct IP5306_Accounting *accounting, struct IP5306_AccountingTotals *totals,
+        enum IP5306_State state, uint64_t ms) {
+    totals->stateMs[state] += ms;
+    totals->energyUj += (uint64_t)accounting->config.statePowerMw[state] * ms;
+}
+
+static void rollPeriod(struct IP5306_Accounting *accounting) {
+    accounting->periods[accounting->periodHead] = accounting->current;
+    accounting->periodHead = (accounting->periodHead + 1) % IP5306_ACCOUNTING_PERIOD_COUNT;
+    if (accounting->periodCount < IP5306_ACCOUNTING_PERIOD_COUNT) {
+        accounting->periodCount++;
+    }
+
+    clearTotals(&accounting->current);
+    accounting->periodElapsedMs = 0;
+}
+
+// Adds time to the running period, closing every period it fills and carrying the rest into the next one
+static void addPeriodTime(struct IP5306_Accounting *accounting, enum IP5306_State state, uint64_t ms) {
+    while (ms > 0) {
+        uint64_t left = (uint64_t)(accounting->config.periodMs - accounting->periodElapsedMs);
+        uint64_t part = ms < left ? ms : left;
+
+        addStateTime(accounting, &accounting->current, state, part);
+        accounting->periodElapsedMs += (int32_t)part;
+        ms -= part;
+
+        if (accounting->periodElapsedMs >= accounting->config.periodMs) {
+            rollPeriod(accounting);
+        }
+    }
+}
+
+// Takes residency accumulated by the driver since the last update, up to cycleTime
+static void advance(struct IP5306_Accounting *accounting, struct IP5306_Platform *platform, uint32_t cycleTime) {
+    const struct IP5306_Stats *stats = platform->stats;
+    uint64_t residencyMs[IP5306_STATE_COUNT];
+
+    IP5306_UpdateStats(platform, cycleTime);
+
+    for (int i = 0; i < IP5306_STATE_COUNT; i++) {
+        // Statistics were reset, count from zero
+        if (stats->stateResidencyMs[i] < accounting->stateResidencyMs[i]) {
+            accounting->stateResidencyMs[i] = 0;
+        }
+
+        residencyMs[i] = stats->stateResidencyMs[i] - accounting->stateResidencyMs[i];
+        accounting->stateResidencyMs[i] = stats->stateResidencyMs[i];
+
+        addStateTime(accounting, &accounting->total, (enum IP5306_State)i, residencyMs[i]);
+    }
+
+    // Residency does not keep the order of states, but the state of the last update came first
+    // and the current state comes last; anything in between can only be short transient states
+    addPeriodTime(accounting, accounting->state, residencyMs[accounting->state]);
+    for (int i = 0; i < IP5306_STATE_COUNT; i++) {
+        if (i != (int)accounting->state && i != (int)platform->state) {
+            addPeriodTime(accounting, (enum IP5306_State)i, residencyMs[i]);
+        }
+    }
+    if (platform->state != accounting->state) {
+        addPeriodTime(accounting, platform->state, residencyMs[platform->state]);
+    }
+}
+
+// Charging interval ends now, so it is split backwards over the running period and the completed ones
+static void addChargingTime(struct IP5306_Accounting *accounting, uint32_t ms) {
+    accounting->total.chargingMs += ms;
+
+    uint32_t part = ms < (uint32_t)accounting->periodElapsedMs ? ms : (uint32_t)accounting->periodElapsedMs;
+    accounting->current.chargingMs += part;
+    ms -= part;
+
+    for (int age = 0; ms > 0 && age < accounting->periodCount; age++) {
+        int index = (accounting->periodHead - 1 - age + IP5306_ACCOUNTING_PERIOD_COUNT) % IP5306_ACCOUNTING_PERIOD_COUNT;
+        part = ms < (uint32_t)accounting->config.periodMs ? ms : (uint32_t)accounting->config.periodMs;
+        accounting->periods[index].chargingMs += part;
+        ms -= part;
+    }
+}
+
+bool IP5306_AccountingInit(struct IP5306_Accounting *accounting, struct IP5306_Platform *platform,
+        const struct IP5306_AccountingConfig *config, uint32_t cycleTime) {
+    if (!platform->stats) {
+        return false;
+    }
+
+    accounting->config = *config;
+    if (accounting->config.periodMs <= 0) {
+        accounting->config.periodMs = 3600000;
+    }
+
+    clearTotals(&accounting->total);
+    clearTotals(&accounting->current);
+    accounting->periodHead = 0;
+    accounting->periodCount = 0;
+    accounting->periodElapsedMs = 0;
+
+    accounting->state = platform->state;
+    accounting->chargingOn = false;
+    accounting->fullyCharged = false;
+    accounting->statusCycleTime = cycleTime;
+    IP5306_UpdateStats(platform, cycleTime);
+    for (int i = 0; i < IP5306_STATE_COUNT; i++) {
+        accounting->stateResidencyMs[i] = platform->stats->stateResidencyMs[i];
+    }
+
+    accounting->chargeStartCycleTime = cycleTime;
+    accounting->lastChargeMs = 0;
+    accounting->longestChargeMs = 0;
+
+    return true;
+}
+
+void IP5306_AccountingUpdate(struct IP5306_Accounting *accounting, struct IP5306_Platform *platform, uint32_t cycleTime) {
+    advance(accounting, platform, cycleTime);
+
+    enum IP5306_State prevState = accounting->state;
+    enum IP5306_State state = platform->state;
+    if (state == prevState) {
+        return;
+    }
+
+    if (state == IP5306_State_Working && (prevState == IP5306_State_Sleep || prevState == IP5306_State_WakingUp)) {
+        accounting->total.wakeUps++;
+        accounting->current.wakeUps++;
+    }
+
+    if (state == IP5306_State_Sleep && (prevState == IP5306_State_Working || prevState == IP5306_State_ShuttingDown)) {
+        accounting->total.shutdowns++;
+        accounting->current.shutdowns++;
+    }
+
+    accounting->state = state;
+}
+
+void IP5306_AccountingUpdateStatus(struct IP5306_Accounting *accounting, struct IP5306_Platform *platform,
+        const struct IP5306_Status *status, uint32_t cycleTime) {
+    IP5306_AccountingUpdate(accounting, platform, cycleTime);
+
+    // Charging time is not a driver state, it is accounted between status polls
+    int32_t elapsed = platform->getTimeDiffMs(cycleTime, accounting->statusCycleTime);
+    if (elapsed > 0 && accounting->chargingOn && !accounting->fullyCharged) {
+        addChargingTime(accounting, (uint32_t)elapsed);
+    }
+    accounting->statusCycleTime = cycleTime;
+
+    if (status->chargingOn && !accounting->chargingOn) {
+        accounting->total.chargeSessions++;
+        accounting->current.chargeSessions++;
+        accounting->chargeStartCycleTime = cycleTime;
+    }
+
+    if (!status->chargingOn && accounting->chargingOn) {
+        accounting->lastChargeMs = platform->getTimeDiffMs(cycleTime, accounting->chargeStartCycleTime);
+        if (accounting->lastChargeMs > accounting->longestChargeMs) {
+            accounting->longestChargeMs = accounting->lastChargeMs;
+        }
+    }
+
+    if (status->fullyCharged && !accounting->fullyCharged) {
+        accounting->total.fullCharges++;
+        accounting->current.fullCharges++;
+    }
+
+    accounting->chargingOn = status->chargingOn;
+    accounting->fullyCharged = status->fullyCharged;
+}
+
+const struct IP5306_AccountingTotals *IP5306_AccountingGetPeriod(struct IP5306_Accounting *accounting, int age) {
+    if (age < 0 || age >= accounting->periodCount) {
+        return 0;
+    }
+
+    int index = (accounting->periodHead - 1 - age + IP5306_ACCOUNTING_PERIOD_COUNT) % IP5306_ACCOUNTING_PERIOD_COUNT;
+
+    return &accounting->periods[index];
+}
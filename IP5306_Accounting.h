@@ -0,0 +1,68 @@
+#ifndef IP5306_ACCOUNTING_H
+#define IP5306_ACCOUNTING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "IP5306.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// NOTE: Accounting of time spent per state and charging, fed from IP5306_Step transitions and status polls.
+// State residency is taken from the driver statistics (platform->stats must be set), brought up to the update time
+// and split into totals and a ring of period rollups. Update after IP5306_Step; time is split at period boundaries,
+// so an update after a long tickless gap closes every period that has elapsed. Energy is estimated from an optional
+// per-state load power model (mW * ms = uJ); leave the model zeroed to skip the estimate.
+
+#define IP5306_ACCOUNTING_PERIOD_COUNT 8
+
+struct IP5306_AccountingTotals {
+    uint64_t stateMs[IP5306_STATE_COUNT];
+    uint64_t chargingMs; // Charging on and not full
+    uint64_t energyUj; // Estimated energy drawn by the load
+    uint32_t wakeUps; // Entries to Working state from Sleep or WakingUp
+    uint32_t shutdowns; // Entries to Sleep state from Working or ShuttingDown
+    uint32_t chargeSessions; // Charging on rising edges
+    uint32_t fullCharges; // Fully charged rising edges
+};
+
+struct IP5306_AccountingConfig {
+    int32_t periodMs; // Rollup period length
+    uint32_t statePowerMw[IP5306_STATE_COUNT]; // Load power per state
+};
+
+struct IP5306_Accounting {
+    struct IP5306_AccountingConfig config;
+
+    struct IP5306_AccountingTotals total;
+    struct IP5306_AccountingTotals current; // Running period
+    struct IP5306_AccountingTotals periods[IP5306_ACCOUNTING_PERIOD_COUNT]; // Completed periods ring
+    int periodHead; // Slot for the next completed period
+    int periodCount; // Number of valid completed periods
+    int32_t periodElapsedMs;
+
+    enum IP5306_State state;
+    bool chargingOn;
+    bool fullyCharged;
+    uint32_t statusCycleTime; // Time of the last status update
+    uint64_t stateResidencyMs[IP5306_STATE_COUNT]; // Driver residency already accounted
+
+    uint32_t chargeStartCycleTime;
+    int32_t lastChargeMs; // Duration of the last completed charge session
+    int32_t longestChargeMs;
+};
+
+bool IP5306_AccountingInit(struct IP5306_Accounting *accounting, struct IP5306_Platform *platform,
+    const struct IP5306_AccountingConfig *config, uint32_t cycleTime); // false when platform->stats is not set
+void IP5306_AccountingUpdate(struct IP5306_Accounting *accounting, struct IP5306_Platform *platform, uint32_t cycleTime);
+void IP5306_AccountingUpdateStatus(struct IP5306_Accounting *accounting, struct IP5306_Platform *platform,
+    const struct IP5306_Status *status, uint32_t cycleTime); // status must contain READ0 and READ1
+const struct IP5306_AccountingTotals *IP5306_AccountingGetPeriod(struct IP5306_Accounting *accounting, int age); // 0 is the latest completed
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IP5306_ACCOUNTING_H
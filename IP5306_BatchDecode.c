@@ -0,0 +1,185 @@
+#include "BitOps.h"
+#include "IP5306_BatchDecode.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define IP5306_BATCH_DECODE_SSE2
+#endif
+
+// CHG_DIG_CTL0 bits 0..4 are the polynomial coefficients: 50 + b0 * 100 + b1 * 200 + ... + b4 * 1600 = 50 + bits * 100
+#define CHARGING_CURRENT_BASE_MA 50
+#define CHARGING_CURRENT_LSB_MA 100
+#define CHARGING_CURRENT_MASK 0x1f
+
+
+static void decodeFieldScalar(const uint8_t *regData, uint8_t *out, size_t count, int firstBit, int bitCount) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = (uint8_t)BITOPS_GET_BITS(regData[i], firstBit, bitCount);
+    }
+}
+
+static void decodeChargingCurrentScalar(const uint8_t *regData, uint16_t *out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = (uint16_t)(CHARGING_CURRENT_BASE_MA + (regData[i] & CHARGING_CURRENT_MASK) * CHARGING_CURRENT_LSB_MA);
+    }
+}
+
+static void decodeBatteryLevelScalar(const uint8_t *regData, uint8_t *out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = IP5306_DecodeBatteryLevel(regData[i]);
+    }
+}
+
+bool IP5306_DecodeFieldBatch(const uint8_t *regData, uint8_t *out, size_t count, int firstBit, int bitCount) {
+    // Kernels shift 16-bit lanes and mask to the field, a field crossing the byte would pick up the neighbour
+    if (firstBit < 0 || bitCount < 1 || firstBit + bitCount > 8) {
+        return false;
+    }
+
+    if (!regData || !out) {
+        return true;
+    }
+
+    size_t i = 0;
+
+    // There is no 8-bit shift, so shift 16-bit lanes and drop bits crossing from the neighbour byte with the mask
+#if defined(__AVX2__)
+    const __m256i mask256 = _mm256_set1_epi8((char)((1 << bitCount) - 1));
+    const __m128i shift256 = _mm_cvtsi32_si128(firstBit);
+    for (; i + 32 <= count; i += 32) {
+        __m256i data = _mm256_loadu_si256((const __m256i *)(regData + i));
+        data = _mm256_and_si256(_mm256_srl_epi16(data, shift256), mask256);
+        _mm256_storeu_si256((__m256i *)(out + i), data);
+    }
+#elif defined(IP5306_BATCH_DECODE_SSE2)
+    const __m128i mask128 = _mm_set1_epi8((char)((1 << bitCount) - 1));
+    const __m128i shift128 = _mm_cvtsi32_si128(firstBit);
+    for (; i + 16 <= count; i += 16) {
+        __m128i data = _mm_loadu_si128((const __m128i *)(regData + i));
+        data = _mm_and_si128(_mm_srl_epi16(data, shift128), mask128);
+        _mm_storeu_si128((__m128i *)(out + i), data);
+    }
+#endif
+
+    decodeFieldScalar(regData + i, out + i, count - i, firstBit, bitCount);
+
+    return true;
+}
+
+void IP5306_DecodeChargingCurrentBatch(const uint8_t *chgDigCtl0RegData, uint16_t *chargingCurrent, size_t count) {
+    if (!chgDigCtl0RegData || !chargingCurrent) {
+        return;
+    }
+
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256i mask256 = _mm256_set1_epi16(CHARGING_CURRENT_MASK);
+    const __m256i lsb256 = _mm256_set1_epi16(CHARGING_CURRENT_LSB_MA);
+    const __m256i base256 = _mm256_set1_epi16(CHARGING_CURRENT_BASE_MA);
+    for (; i + 16 <= count; i += 16) {
+        __m256i data = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(chgDigCtl0RegData + i)));
+        data = _mm256_and_si256(data, mask256);
+        data = _mm256_add_epi16(_mm256_mullo_epi16(data, lsb256), base256);
+        _mm256_storeu_si256((__m256i *)(chargingCurrent + i), data);
+    }
+#elif defined(IP5306_BATCH_DECODE_SSE2)
+    const __m128i zero128 = _mm_setzero_si128();
+    const __m128i mask128 = _mm_set1_epi16(CHARGING_CURRENT_MASK);
+    const __m128i lsb128 = _mm_set1_epi16(CHARGING_CURRENT_LSB_MA);
+    const __m128i base128 = _mm_set1_epi16(CHARGING_CURRENT_BASE_MA);
+    for (; i + 16 <= count; i += 16) {
+        __m128i data = _mm_loadu_si128((const __m128i *)(chgDigCtl0RegData + i));
+        __m128i lo = _mm_and_si128(_mm_unpacklo_epi8(data, zero128), mask128);
+        __m128i hi = _mm_and_si128(_mm_unpackhi_epi8(data, zero128), mask128);
+        lo = _mm_add_epi16(_mm_mullo_epi16(lo, lsb128), base128);
+        hi = _mm_add_epi16(_mm_mullo_epi16(hi, lsb128), base128);
+        _mm_storeu_si128((__m128i *)(chargingCurrent + i), lo);
+        _mm_storeu_si128((__m128i *)(chargingCurrent + i + 8), hi);
+    }
+#endif
+
+    decodeChargingCurrentScalar(chgDigCtl0RegData + i, chargingCurrent + i, count - i);
+}
+
+// Four codes are compared per lane and the matching level is selected with the compare mask
+void IP5306_DecodeBatteryLevelBatch(const uint8_t *read4RegData, uint8_t *batteryLevel, size_t count) {
+    if (!read4RegData || !batteryLevel) {
+        return;
+    }
+
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256i nibble256 = _mm256_set1_epi8(0x0f);
+    for (; i + 32 <= count; i += 32) {
+        __m256i data = _mm256_loadu_si256((const __m256i *)(read4RegData + i));
+        __m256i code = _mm256_and_si256(_mm256_srli_epi16(data, 4), nibble256);
+        __m256i level = _mm256_and_si256(_mm256_cmpeq_epi8(code, _mm256_set1_epi8(IP5306_BATTERY_LEVEL_100_CODE)), _mm256_set1_epi8(100));
+        level = _mm256_or_si256(level, _mm256_and_si256(_mm256_cmpeq_epi8(code, _mm256_set1_epi8(IP5306_BATTERY_LEVEL_75_CODE)), _mm256_set1_epi8(75)));
+        level = _mm256_or_si256(level, _mm256_and_si256(_mm256_cmpeq_epi8(code, _mm256_set1_epi8(IP5306_BATTERY_LEVEL_50_CODE)), _mm256_set1_epi8(50)));
+        level = _mm256_or_si256(level, _mm256_and_si256(_mm256_cmpeq_epi8(code, _mm256_set1_epi8(IP5306_BATTERY_LEVEL_25_CODE)), _mm256_set1_epi8(25)));
+        _mm256_storeu_si256((__m256i *)(batteryLevel + i), level);
+    }
+#elif defined(IP5306_BATCH_DECODE_SSE2)
+    const __m128i nibble128 = _mm_set1_epi8(0x0f);
+    for (; i + 16 <= count; i += 16) {
+        __m128i data = _mm_loadu_si128((const __m128i *)(read4RegData + i));
+        __m128i code = _mm_and_si128(_mm_srli_epi16(data, 4), nibble128);
+        __m128i level = _mm_and_si128(_mm_cmpeq_epi8(code, _mm_set1_epi8(IP5306_BATTERY_LEVEL_100_CODE)), _mm_set1_epi8(100));
+        level = _mm_or_si128(level, _mm_and_si128(_mm_cmpeq_epi8(code, _mm_set1_epi8(IP5306_BATTERY_LEVEL_75_CODE)), _mm_set1_epi8(75)));
+        level = _mm_or_si128(level, _mm_and_si128(_mm_cmpeq_epi8(code, _mm_set1_epi8(IP5306_BATTERY_LEVEL_50_CODE)), _mm_set1_epi8(50)));
+        level = _mm_or_si128(level, _mm_and_si128(_mm_cmpeq_epi8(code, _mm_set1_epi8(IP5306_BATTERY_LEVEL_25_CODE)), _mm_set1_epi8(25)));
+        _mm_storeu_si128((__m128i *)(batteryLevel + i), level);
+    }
+#endif
+
+    decodeBatteryLevelScalar(read4RegData + i, batteryLevel + i, count - i);
+}
+
+void IP5306_DecodeSystemControlBatch(const struct IP5306_SystemControlColumns *columns, size_t count) {
+    // SYS_CTL0
+    IP5306_DecodeFieldBatch(columns->sysCtl0RegData, columns->boostEnable, count, 5, 1);
+    IP5306_DecodeFieldBatch(columns->sysCtl0RegData, columns->chargerEnable, count, 4, 1);
+    IP5306_DecodeFieldBatch(columns->sysCtl0RegData, columns->autoPowerOn, count, 2, 1);
+    IP5306_DecodeFieldBatch(columns->sysCtl0RegData, columns->outputNormallyOpen, count, 1, 1);
+    IP5306_DecodeFieldBatch(columns->sysCtl0RegData, columns->keyShutdownEnable, count, 0, 1);
+
+    // SYS_CTL1
+    IP5306_DecodeFieldBatch(columns->sysCtl1RegData, columns->disableBoostControl, count, 7, 1);
+    IP5306_DecodeFieldBatch(columns->sysCtl1RegData, columns->switchWLEDControl, count, 6, 1);
+    IP5306_DecodeFieldBatch(columns->sysCtl1RegData, columns->shortPressSwitchBoostEnable, count, 5, 1);
+    IP5306_DecodeFieldBatch(columns->sysCtl1RegData, columns->enableBoostAfterVINUnplug, count, 2, 1);
+    IP5306_DecodeFieldBatch(columns->sysCtl1RegData, columns->batlow3V0ShutdownEnable, count, 0, 1);
+
+    // SYS_CTL2
+    IP5306_DecodeFieldBatch(columns->sysCtl2RegData, columns->lightLoadShutdownTime, count, 2, 2);
+}
+
+void IP5306_DecodeChargerControlBatch(const struct IP5306_ChargerControlColumns *columns, size_t count) {
+    IP5306_DecodeFieldBatch(columns->chargerCtl0RegData, columns->chargerFullStop, count, 0, 2);
+
+    IP5306_DecodeFieldBatch(columns->chargerCtl1RegData, columns->endCurrentDetection, count, 6, 2);
+    IP5306_DecodeFieldBatch(columns->chargerCtl1RegData, columns->chargingUndervoltageLoop, count, 2, 3);
+
+    IP5306_DecodeFieldBatch(columns->chargerCtl2RegData, columns->batteryVoltage, count, 2, 2);
+    IP5306_DecodeFieldBatch(columns->chargerCtl2RegData, columns->constantVoltageCharging, count, 0, 2);
+
+    IP5306_DecodeFieldBatch(columns->chargerCtl3RegData, columns->chargingCurrentLoop, count, 5, 1);
+
+    IP5306_DecodeChargingCurrentBatch(columns->chgDigCtl0RegData, columns->chargingCurrent, count);
+}
+
+void IP5306_DecodeStatusBatch(const struct IP5306_StatusColumns *columns, size_t count) {
+    IP5306_DecodeFieldBatch(columns->read0RegData, columns->chargingOn, count, 3, 1);
+    IP5306_DecodeFieldBatch(columns->read1RegData, columns->fullyCharged, count, 3, 1);
+    IP5306_DecodeFieldBatch(columns->read2RegData, columns->lightLoad, count, 2, 1);
+
+    IP5306_DecodeFieldBatch(columns->read3RegData, columns->doubleClick, count, 2, 1);
+    IP5306_DecodeFieldBatch(columns->read3RegData, columns->longPress, count, 1, 1);
+    IP5306_DecodeFieldBatch(columns->read3RegData, columns->shortPress, count, 0, 1);
+
+    IP5306_DecodeBatteryLevelBatch(columns->read4RegData, columns->batteryLevel, count);
+}
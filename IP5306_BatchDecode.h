@@ -0,0 +1,87 @@
+#ifndef IP5306_BATCH_DECODE_H
+#define IP5306_BATCH_DECODE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "IP5306.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// NOTE: Batch decoder for logged register images stored as columns (one array of raw bytes per register).
+// Field layout is the same as in IP5306_Read* functions. Kernels use SSE2/AVX2 when the compiler targets them
+// and fall back to scalar code otherwise. Boolean and enum outputs are one byte per record.
+
+struct IP5306_SystemControlColumns {
+    const uint8_t *sysCtl0RegData;
+    const uint8_t *sysCtl1RegData;
+    const uint8_t *sysCtl2RegData;
+
+    // SYS_CTL0
+    uint8_t *boostEnable;
+    uint8_t *chargerEnable;
+    uint8_t *autoPowerOn;
+    uint8_t *outputNormallyOpen;
+    uint8_t *keyShutdownEnable;
+
+    // SYS_CTL1
+    uint8_t *disableBoostControl;
+    uint8_t *switchWLEDControl;
+    uint8_t *shortPressSwitchBoostEnable;
+    uint8_t *enableBoostAfterVINUnplug;
+    uint8_t *batlow3V0ShutdownEnable;
+
+    // SYS_CTL2
+    uint8_t *lightLoadShutdownTime;
+};
+
+struct IP5306_ChargerControlColumns {
+    const uint8_t *chargerCtl0RegData;
+    const uint8_t *chargerCtl1RegData;
+    const uint8_t *chargerCtl2RegData;
+    const uint8_t *chargerCtl3RegData;
+    const uint8_t *chgDigCtl0RegData;
+
+    uint8_t *chargerFullStop;
+    uint8_t *endCurrentDetection;
+    uint8_t *chargingUndervoltageLoop;
+    uint8_t *batteryVoltage;
+    uint8_t *constantVoltageCharging;
+    uint8_t *chargingCurrentLoop;
+    uint16_t *chargingCurrent; // mA
+};
+
+struct IP5306_StatusColumns {
+    const uint8_t *read0RegData;
+    const uint8_t *read1RegData;
+    const uint8_t *read2RegData;
+    const uint8_t *read3RegData;
+    const uint8_t *read4RegData;
+
+    uint8_t *chargingOn;
+    uint8_t *fullyCharged;
+    uint8_t *lightLoad;
+    uint8_t *doubleClick;
+    uint8_t *longPress;
+    uint8_t *shortPress;
+    uint8_t *batteryLevel; // %, 0, 25, 50, 75 or 100
+};
+
+// Any input or output column may be NULL, then the corresponding fields are skipped.
+// Field must lie within the byte: firstBit >= 0, bitCount >= 1, firstBit + bitCount <= 8, otherwise false is returned.
+bool IP5306_DecodeFieldBatch(const uint8_t *regData, uint8_t *out, size_t count, int firstBit, int bitCount);
+void IP5306_DecodeChargingCurrentBatch(const uint8_t *chgDigCtl0RegData, uint16_t *chargingCurrent, size_t count);
+void IP5306_DecodeBatteryLevelBatch(const uint8_t *read4RegData, uint8_t *batteryLevel, size_t count);
+
+void IP5306_DecodeSystemControlBatch(const struct IP5306_SystemControlColumns *columns, size_t count);
+void IP5306_DecodeChargerControlBatch(const struct IP5306_ChargerControlColumns *columns, size_t count);
+void IP5306_DecodeStatusBatch(const struct IP5306_StatusColumns *columns, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IP5306_BATCH_DECODE_H
@@ -0,0 +1,314 @@
+#include "IP5306_BusScheduler.h"
+
+#define TRANSFER_QUEUE_FULL (-1)
+
+struct SyncTransfer {
+    bool done;
+    int result;
+    uint8_t *data; // Read destination
+};
+
+
+static int32_t getSettleDelayMs(struct IP5306_BusScheduler *scheduler, uint8_t addr7bit, uint32_t cycleTime) {
+    for (int i = 0; i < IP5306_BUS_SETTLE_SLOTS; i++) {
+        struct IP5306_BusSettleSlot *slot = &scheduler->settle[i];
+        if (!slot->active || slot->addr7bit != addr7bit) {
+            continue;
+        }
+
+        int32_t delay = slot->settleMs - scheduler->platform->getTimeDiffMs(cycleTime, slot->startCycleTime);
+        if (delay <= 0) {
+            slot->active = false;
+            return 0;
+        }
+
+        return delay;
+    }
+
+    return 0;
+}
+
+static bool startSettle(struct IP5306_BusScheduler *scheduler, uint8_t addr7bit, int settleMs, uint32_t cycleTime) {
+    struct IP5306_BusSettleSlot *freeSlot = 0;
+
+    for (int i = 0; i < IP5306_BUS_SETTLE_SLOTS; i++) {
+        struct IP5306_BusSettleSlot *slot = &scheduler->settle[i];
+        if (slot->active && scheduler->platform->getTimeDiffMs(cycleTime, slot->startCycleTime) >= slot->settleMs) {
+            slot->active = false;
+        }
+
+        if (slot->active && slot->addr7bit == addr7bit) {
+            freeSlot = slot;
+            break;
+        }
+        if (!slot->active && !freeSlot) {
+            freeSlot = slot;
+        }
+    }
+
+    if (!freeSlot) {
+        return false;
+    }
+
+    freeSlot->active = true;
+    freeSlot->addr7bit = addr7bit;
+    freeSlot->startCycleTime = cycleTime;
+    freeSlot->settleMs = settleMs;
+
+    return true;
+}
+
+// Earlier transaction for the same device must run first
+static bool isOldestForDevice(struct IP5306_BusScheduler *scheduler, const struct IP5306_BusTransaction *transaction) {
+    for (int i = 0; i < IP5306_BUS_QUEUE_SIZE; i++) {
+        const struct IP5306_BusTransaction *other = &scheduler->queue[i];
+        if (!(scheduler->usedMask & (1ul << i)) || other == transaction) {
+            continue;
+        }
+
+        if (other->addr7bit == transaction->addr7bit && (int32_t)(other->sequence - transaction->sequence) < 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static int32_t getDeadlineLeftMs(struct IP5306_BusScheduler *scheduler, const struct IP5306_BusTransaction *transaction, uint32_t cycleTime) {
+    if (transaction->deadlineMs == IP5306_BUS_NO_DEADLINE) {
+        return INT32_MAX;
+    }
+
+    return transaction->deadlineMs - scheduler->platform->getTimeDiffMs(cycleTime, transaction->submitCycleTime);
+}
+
+// Highest priority first, then earliest deadline, then submit order
+static bool isBetter(struct IP5306_BusScheduler *scheduler, const struct IP5306_BusTransaction *a,
+        const struct IP5306_BusTransaction *b, uint32_t cycleTime) {
+    if (a->priority != b->priority) {
+        return a->priority > b->priority;
+    }
+
+    int32_t deadlineA = getDeadlineLeftMs(scheduler, a, cycleTime);
+    int32_t deadlineB = getDeadlineLeftMs(scheduler, b, cycleTime);
+    if (deadlineA != deadlineB) {
+        return deadlineA < deadlineB;
+    }
+
+    return (int32_t)(a->sequence - b->sequence) < 0;
+}
+
+void IP5306_BusSchedulerInit(struct IP5306_BusScheduler *scheduler, struct IP5306_Platform *platform) {
+    scheduler->platform = platform;
+    scheduler->usedMask = 0;
+    scheduler->nextSequence = 0;
+
+    for (int i = 0; i < IP5306_BUS_SETTLE_SLOTS; i++) {
+        scheduler->settle[i].active = false;
+    }
+
+    scheduler->driverPriority = 0;
+    scheduler->driverClass = 0;
+
+    IP5306_BusSchedulerResetStats(scheduler);
+}
+
+bool IP5306_BusSchedulerSubmit(struct IP5306_BusScheduler *scheduler, const struct IP5306_BusTransaction *transaction, uint32_t cycleTime) {
+    if (transaction->busClass >= IP5306_BUS_CLASS_COUNT || transaction->length > IP5306_BUS_MAX_DATA) {
+        return false;
+    }
+
+    for (int i = 0; i < IP5306_BUS_QUEUE_SIZE; i++) {
+        if (scheduler->usedMask & (1ul << i)) {
+            continue;
+        }
+
+        scheduler->queue[i] = *transaction;
+        scheduler->queue[i].submitCycleTime = cycleTime;
+        scheduler->queue[i].sequence = scheduler->nextSequence++;
+        scheduler->usedMask |= 1ul << i;
+
+        return true;
+    }
+
+    scheduler->platform->debugPrint("IP5306: Bus queue full\r\n");
+    return false;
+}
+
+bool IP5306_BusSchedulerPoll(struct IP5306_BusScheduler *scheduler, uint32_t cycleTime) {
+    struct IP5306_Platform *platform = scheduler->platform;
+    int best = -1;
+
+    for (int i = 0; i < IP5306_BUS_QUEUE_SIZE; i++) {
+        const struct IP5306_BusTransaction *transaction = &scheduler->queue[i];
+        if (!(scheduler->usedMask & (1ul << i))) {
+            continue;
+        }
+
+        if (getSettleDelayMs(scheduler, transaction->addr7bit, cycleTime) > 0 || !isOldestForDevice(scheduler, transaction)) {
+            continue;
+        }
+
+        if (best < 0 || isBetter(scheduler, transaction, &scheduler->queue[best], cycleTime)) {
+            best = i;
+        }
+    }
+
+    if (best < 0) {
+        return false;
+    }
+
+    // Free the slot first, so completion callback can submit follow-up transactions
+    struct IP5306_BusTransaction transaction = scheduler->queue[best];
+    scheduler->usedMask &= ~(1ul << best);
+
+    struct IP5306_BusClassStats *stats = &scheduler->stats[transaction.busClass];
+    int32_t latency = platform->getTimeDiffMs(cycleTime, transaction.submitCycleTime);
+    if (getDeadlineLeftMs(scheduler, &transaction, cycleTime) < 0) {
+        stats->deadlineMisses++;
+    }
+
+    int ret;
+    if (transaction.write) {
+        ret = platform->i2cWriteReg(transaction.addr7bit, transaction.regNum, transaction.data, transaction.length, 0);
+        if (ret >= 0 && transaction.settleMs > 0 &&
+                !startSettle(scheduler, transaction.addr7bit, transaction.settleMs, platform->getCycleTime())) {
+            // No slot to track the device, fall back to blocking wait
+            platform->delayMs(transaction.settleMs);
+        }
+    } else {
+        ret = platform->i2cReadReg(transaction.addr7bit, transaction.regNum, transaction.data, transaction.length, transaction.timeoutMs);
+    }
+
+    stats->count++;
+    stats->totalLatencyMs += latency > 0 ? (uint32_t)latency : 0;
+    if (latency > stats->maxLatencyMs) {
+        stats->maxLatencyMs = latency;
+    }
+    if (ret < 0) {
+        stats->failures++;
+    }
+
+    if (transaction.complete) {
+        transaction.complete(&transaction, ret, transaction.context);
+    }
+
+    return true;
+}
+
+int32_t IP5306_BusSchedulerGetNextPollDelayMs(struct IP5306_BusScheduler *scheduler, uint32_t cycleTime) {
+    int32_t delay = IP5306_BUS_NO_DEADLINE;
+
+    for (int i = 0; i < IP5306_BUS_QUEUE_SIZE; i++) {
+        const struct IP5306_BusTransaction *transaction = &scheduler->queue[i];
+        if (!(scheduler->usedMask & (1ul << i))) {
+            continue;
+        }
+
+        int32_t settleDelay = getSettleDelayMs(scheduler, transaction->addr7bit, cycleTime);
+        if (delay == IP5306_BUS_NO_DEADLINE || settleDelay < delay) {
+            delay = settleDelay;
+        }
+    }
+
+    return delay;
+}
+
+void IP5306_BusSchedulerResetStats(struct IP5306_BusScheduler *scheduler) {
+    for (int i = 0; i < IP5306_BUS_CLASS_COUNT; i++) {
+        struct IP5306_BusClassStats *stats = &scheduler->stats[i];
+        stats->count = 0;
+        stats->failures = 0;
+        stats->deadlineMisses = 0;
+        stats->totalLatencyMs = 0;
+        stats->maxLatencyMs = 0;
+    }
+}
+
+static void completeSyncTransfer(const struct IP5306_BusTransaction *transaction, int result, void *context) {
+    struct SyncTransfer *sync = (struct SyncTransfer *)context;
+
+    if (!transaction->write && result >= 0) {
+        for (int i = 0; i < transaction->length; i++) {
+            sync->data[i] = transaction->data[i];
+        }
+    }
+
+    sync->result = result;
+    sync->done = true;
+}
+
+// Runs the scheduler until the transfer is done, other devices' transactions go first when they win
+static int runSyncTransfer(struct IP5306_BusScheduler *scheduler, struct IP5306_BusTransaction *transaction,
+        struct SyncTransfer *sync) {
+    struct IP5306_Platform *platform = scheduler->platform;
+
+    transaction->busClass = scheduler->driverClass;
+    transaction->priority = scheduler->driverPriority;
+    transaction->deadlineMs = IP5306_BUS_NO_DEADLINE;
+    transaction->complete = completeSyncTransfer;
+    transaction->context = sync;
+
+    sync->done = false;
+    sync->result = TRANSFER_QUEUE_FULL;
+
+    if (!IP5306_BusSchedulerSubmit(scheduler, transaction, platform->getCycleTime())) {
+        return TRANSFER_QUEUE_FULL;
+    }
+
+    while (!sync->done) {
+        uint32_t cycleTime = platform->getCycleTime();
+        if (IP5306_BusSchedulerPoll(scheduler, cycleTime)) {
+            continue;
+        }
+
+        // Everything runnable is done, wait for the nearest device to settle
+        int32_t delay = IP5306_BusSchedulerGetNextPollDelayMs(scheduler, cycleTime);
+        platform->delayMs(delay > 0 ? delay : 1);
+    }
+
+    return sync->result;
+}
+
+int IP5306_BusSchedulerReadReg(struct IP5306_BusScheduler *scheduler, uint8_t addr7bit, uint8_t regNum,
+        uint8_t *data, uint8_t length, int timeoutMs) {
+    struct IP5306_BusTransaction transaction;
+    struct SyncTransfer sync;
+
+    if (length > IP5306_BUS_MAX_DATA) {
+        return TRANSFER_QUEUE_FULL;
+    }
+
+    transaction.addr7bit = addr7bit;
+    transaction.regNum = regNum;
+    transaction.write = false;
+    transaction.length = length;
+    transaction.timeoutMs = timeoutMs;
+    transaction.settleMs = 0;
+    sync.data = data;
+
+    return runSyncTransfer(scheduler, &transaction, &sync);
+}
+
+int IP5306_BusSchedulerWriteReg(struct IP5306_BusScheduler *scheduler, uint8_t addr7bit, uint8_t regNum,
+        const uint8_t *data, uint8_t length, int settleMs) {
+    struct IP5306_BusTransaction transaction;
+    struct SyncTransfer sync;
+
+    if (length > IP5306_BUS_MAX_DATA) {
+        return TRANSFER_QUEUE_FULL;
+    }
+
+    transaction.addr7bit = addr7bit;
+    transaction.regNum = regNum;
+    transaction.write = true;
+    transaction.length = length;
+    for (int i = 0; i < length; i++) {
+        transaction.data[i] = data[i];
+    }
+    transaction.timeoutMs = 0;
+    transaction.settleMs = settleMs;
+    sync.data = 0;
+
+    return runSyncTransfer(scheduler, &transaction, &sync);
+}
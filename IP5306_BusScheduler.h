@@ -0,0 +1,96 @@
+#ifndef IP5306_BUS_SCHEDULER_H
+#define IP5306_BUS_SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "IP5306.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// NOTE: Scheduler queues register transactions of all devices on the shared bus (IP5306 and others)
+// and runs them one at a time from IP5306_BusSchedulerPoll. Writes are issued without a blocking wait;
+// instead the written device is marked busy for the settle time while other devices keep using the bus.
+// Transactions of one device run in submit order, across devices the highest priority and then
+// the earliest deadline wins.
+// IP5306 driver traffic goes through the scheduler when platform scheduleReadReg / scheduleWriteReg wrap
+// IP5306_BusSchedulerReadReg / IP5306_BusSchedulerWriteReg. These submit with driverPriority and driverClass and
+// poll the scheduler until the transfer is done, so queued transactions of other devices keep running while
+// the IP5306 settles. Completion callbacks must not call them (no reentrancy).
+
+#define IP5306_BUS_QUEUE_SIZE 16
+#define IP5306_BUS_CLASS_COUNT 4
+#define IP5306_BUS_MAX_DATA 8
+#define IP5306_BUS_SETTLE_SLOTS 4
+
+#define IP5306_BUS_NO_DEADLINE (-1)
+#define IP5306_BUS_WRITE_SETTLE_MS 5 // IP5306 settle time after register write
+
+struct IP5306_BusTransaction {
+    uint8_t busClass; // Statistics class, 0..IP5306_BUS_CLASS_COUNT-1
+    uint8_t priority; // Higher value runs first
+    uint8_t addr7bit;
+    uint8_t regNum;
+    bool write;
+    uint8_t length;
+    uint8_t data[IP5306_BUS_MAX_DATA]; // Write data or read result
+    int timeoutMs; // Read timeout
+    int settleMs; // Device is not accessed for this time after write
+    int32_t deadlineMs; // Relative to submit time or IP5306_BUS_NO_DEADLINE
+    void (*complete)(const struct IP5306_BusTransaction *transaction, int result, void *context);
+    void *context;
+
+    // Filled by scheduler
+    uint32_t submitCycleTime;
+    uint32_t sequence;
+};
+
+struct IP5306_BusClassStats {
+    uint32_t count; // Completed transactions
+    uint32_t failures; // Transactions with negative bus result
+    uint32_t deadlineMisses; // Transactions started after their deadline
+    uint64_t totalLatencyMs; // Sum of queueing latencies
+    int32_t maxLatencyMs; // Worst queueing latency
+};
+
+struct IP5306_BusSettleSlot {
+    bool active;
+    uint8_t addr7bit;
+    uint32_t startCycleTime;
+    int settleMs;
+};
+
+struct IP5306_BusScheduler {
+    struct IP5306_Platform *platform;
+
+    struct IP5306_BusTransaction queue[IP5306_BUS_QUEUE_SIZE];
+    uint32_t usedMask;
+    uint32_t nextSequence;
+
+    struct IP5306_BusSettleSlot settle[IP5306_BUS_SETTLE_SLOTS];
+    struct IP5306_BusClassStats stats[IP5306_BUS_CLASS_COUNT];
+
+    // Synchronous transfers of the IP5306 driver, 0 after init
+    uint8_t driverPriority;
+    uint8_t driverClass;
+};
+
+void IP5306_BusSchedulerInit(struct IP5306_BusScheduler *scheduler, struct IP5306_Platform *platform);
+bool IP5306_BusSchedulerSubmit(struct IP5306_BusScheduler *scheduler, const struct IP5306_BusTransaction *transaction, uint32_t cycleTime);
+bool IP5306_BusSchedulerPoll(struct IP5306_BusScheduler *scheduler, uint32_t cycleTime);
+int32_t IP5306_BusSchedulerGetNextPollDelayMs(struct IP5306_BusScheduler *scheduler, uint32_t cycleTime);
+void IP5306_BusSchedulerResetStats(struct IP5306_BusScheduler *scheduler);
+
+// Blocking helpers for platform scheduleReadReg / scheduleWriteReg, return the bus result
+int IP5306_BusSchedulerReadReg(struct IP5306_BusScheduler *scheduler, uint8_t addr7bit, uint8_t regNum,
+    uint8_t *data, uint8_t length, int timeoutMs);
+int IP5306_BusSchedulerWriteReg(struct IP5306_BusScheduler *scheduler, uint8_t addr7bit, uint8_t regNum,
+    const uint8_t *data, uint8_t length, int settleMs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IP5306_BUS_SCHEDULER_H
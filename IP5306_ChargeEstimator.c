@@ -0,0 +1,198 @@
+#include "IP5306_ChargeEstimator.h"
+
+#define LEARNING_WEIGHT_SHIFT 2 // New sample weight is 1/4 once enough samples are collected
+#define CONFIDENT_SAMPLES 4
+
+
+static int levelToPhase(int batteryLevel) {
+    int phase = batteryLevel / 25;
+    if (phase < 0) {
+        phase = 0;
+    }
+    if (phase >= IP5306_CHARGE_PHASE_COUNT) {
+        phase = IP5306_CHARGE_PHASE_COUNT - 1;
+    }
+
+    return phase;
+}
+
+static void learnPhase(struct IP5306_ChargePhaseModel *model, int32_t durationMs) {
+    // Invalid or backwards time is not a duration
+    if (durationMs <= 0) {
+        return;
+    }
+
+    int32_t error = durationMs - (int32_t)model->meanMs;
+    uint32_t absError = error < 0 ? (uint32_t)-error : (uint32_t)error;
+
+    if (model->samples == 0) {
+        model->meanMs = (uint32_t)durationMs;
+        model->deviationMs = (uint32_t)durationMs / 4; // No spread known yet, assume 25%
+    } else if (model->samples < (1 << LEARNING_WEIGHT_SHIFT)) {
+        // Running average until there are enough samples for the exponential one
+        model->meanMs = (uint32_t)((int32_t)model->meanMs + error / (model->samples + 1));
+        model->deviationMs = (uint32_t)((int32_t)model->deviationMs + ((int32_t)absError - (int32_t)model->deviationMs) / (model->samples + 1));
+    } else {
+        // Division, right shift of a negative value is implementation-defined
+        model->meanMs = (uint32_t)((int32_t)model->meanMs + error / (1 << LEARNING_WEIGHT_SHIFT));
+        model->deviationMs = (uint32_t)((int32_t)model->deviationMs + ((int32_t)absError - (int32_t)model->deviationMs) / (1 << LEARNING_WEIGHT_SHIFT));
+    }
+
+    if (model->samples < UINT16_MAX) {
+        model->samples++;
+    }
+}
+
+void IP5306_ChargeEstimatorInit(struct IP5306_ChargeEstimator *estimator, const struct IP5306_ChargerControl *chargerControl) {
+    for (int i = 0; i < IP5306_CHARGE_PHASE_COUNT; i++) {
+        estimator->phases[i].meanMs = 0;
+        estimator->phases[i].deviationMs = 0;
+        estimator->phases[i].samples = 0;
+    }
+
+    estimator->chargingCurrent = chargerControl->chargingCurrent;
+    estimator->batteryVoltage = chargerControl->batteryVoltage;
+    estimator->endCurrentDetection = chargerControl->endCurrentDetection;
+
+    estimator->charging = false;
+    estimator->fullyCharged = false;
+    estimator->phase = 0;
+    estimator->phaseTracked = false;
+    estimator->phaseStartCycleTime = 0;
+}
+
+void IP5306_ChargeEstimatorSetConfig(struct IP5306_ChargeEstimator *estimator, const struct IP5306_ChargerControl *chargerControl) {
+    // Safe to call every loop, learning is interrupted only by an actual change
+    if (chargerControl->chargingCurrent == estimator->chargingCurrent &&
+            chargerControl->batteryVoltage == estimator->batteryVoltage &&
+            chargerControl->endCurrentDetection == estimator->endCurrentDetection) {
+        return;
+    }
+
+    // Constant current phases take time inversely proportional to the charging current
+    if (chargerControl->chargingCurrent != estimator->chargingCurrent && chargerControl->chargingCurrent > 0) {
+        for (int i = 0; i < IP5306_CHARGE_PHASE_CV; i++) {
+            struct IP5306_ChargePhaseModel *model = &estimator->phases[i];
+            model->meanMs = (uint32_t)((uint64_t)model->meanMs * estimator->chargingCurrent / chargerControl->chargingCurrent);
+            model->deviationMs = (uint32_t)((uint64_t)model->deviationMs * estimator->chargingCurrent / chargerControl->chargingCurrent);
+        }
+    }
+
+    // Constant voltage tail depends on the target voltage and end current, relearn it
+    if (chargerControl->batteryVoltage != estimator->batteryVoltage ||
+            chargerControl->endCurrentDetection != estimator->endCurrentDetection) {
+        struct IP5306_ChargePhaseModel *model = &estimator->phases[IP5306_CHARGE_PHASE_CV];
+        model->meanMs = 0;
+        model->deviationMs = 0;
+        model->samples = 0;
+    }
+
+    estimator->chargingCurrent = chargerControl->chargingCurrent;
+    estimator->batteryVoltage = chargerControl->batteryVoltage;
+    estimator->endCurrentDetection = chargerControl->endCurrentDetection;
+
+    // Running phase was partly charged with other settings
+    estimator->phaseTracked = false;
+}
+
+void IP5306_ChargeEstimatorUpdate(struct IP5306_ChargeEstimator *estimator, struct IP5306_Platform *platform,
+        const struct IP5306_Status *status, uint32_t cycleTime) {
+    bool charging = status->chargingOn && !status->fullyCharged;
+    int phase = levelToPhase(status->batteryLevel);
+
+    estimator->fullyCharged = status->fullyCharged;
+
+    if (!charging) {
+        // Constant voltage tail ends with the full flag
+        if (estimator->charging && status->fullyCharged &&
+                estimator->phase == IP5306_CHARGE_PHASE_CV && estimator->phaseTracked) {
+            learnPhase(&estimator->phases[IP5306_CHARGE_PHASE_CV],
+                platform->getTimeDiffMs(cycleTime, estimator->phaseStartCycleTime));
+        }
+
+        estimator->charging = false;
+        return;
+    }
+
+    if (!estimator->charging) {
+        // Charging started in the middle of a phase, its duration is unknown
+        estimator->charging = true;
+        estimator->phase = phase;
+        estimator->phaseTracked = false;
+        estimator->phaseStartCycleTime = cycleTime;
+        return;
+    }
+
+    if (phase != estimator->phase) {
+        if (phase == estimator->phase + 1 && estimator->phaseTracked) {
+            learnPhase(&estimator->phases[estimator->phase],
+                platform->getTimeDiffMs(cycleTime, estimator->phaseStartCycleTime));
+        }
+
+        // Level drop (e.g. heavy load) or skipped level does not give a clean boundary
+        estimator->phaseTracked = phase == estimator->phase + 1;
+        estimator->phase = phase;
+        estimator->phaseStartCycleTime = cycleTime;
+    }
+}
+
+void IP5306_ChargeEstimatorGetEstimate(struct IP5306_ChargeEstimator *estimator, struct IP5306_Platform *platform,
+        uint32_t cycleTime, struct IP5306_ChargeEstimate *estimate) {
+    estimate->charging = estimator->charging;
+    estimate->fullyCharged = estimator->fullyCharged;
+    estimate->remainingMs = 0;
+    estimate->uncertaintyMs = 0;
+    estimate->confidence = 0;
+    estimate->valid = false;
+
+    if (estimator->fullyCharged) {
+        estimate->valid = true;
+        estimate->confidence = 100;
+        return;
+    }
+
+    if (!estimator->charging) {
+        return;
+    }
+
+    int32_t elapsed = platform->getTimeDiffMs(cycleTime, estimator->phaseStartCycleTime);
+    int64_t remaining = 0;
+    int64_t uncertainty = 0;
+    int minSamples = CONFIDENT_SAMPLES;
+
+    for (int i = estimator->phase; i < IP5306_CHARGE_PHASE_COUNT; i++) {
+        const struct IP5306_ChargePhaseModel *model = &estimator->phases[i];
+        if (model->samples < minSamples) {
+            minSamples = model->samples;
+        }
+
+        if (i == estimator->phase) {
+            // Running phase may already take longer than learned, then only its deviation is left
+            int64_t left = (int64_t)model->meanMs - elapsed;
+            remaining += left > 0 ? left : 0;
+        } else {
+            remaining += model->meanMs;
+        }
+        uncertainty += model->deviationMs;
+    }
+
+    if (minSamples == 0) {
+        return;
+    }
+
+    if (remaining > INT32_MAX) {
+        remaining = INT32_MAX;
+    }
+    if (uncertainty > INT32_MAX) {
+        uncertainty = INT32_MAX;
+    }
+
+    estimate->valid = true;
+    estimate->remainingMs = (int32_t)remaining;
+    estimate->uncertaintyMs = (int32_t)uncertainty;
+
+    // Confidence grows with the number of learned cycles and drops with relative spread
+    int64_t total = remaining + uncertainty;
+    int sampleConfidence = minSamples * 100 / CONFIDENT_SAMPLES;
+    estimate->confidence = total > 0 ? (int)(sampleConfidence * remaining / total) : sampleConfidence;
+}
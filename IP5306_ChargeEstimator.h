@@ -0,0 +1,62 @@
+#ifndef IP5306_CHARGE_ESTIMATOR_H
+#define IP5306_CHARGE_ESTIMATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "IP5306.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// NOTE: Charging is split into phases by the READ4 battery level: levels 0/25/50/75 are the constant current part,
+// level 100 until the READ1 full flag is the constant voltage tail. Duration of every phase is learned per unit
+// across charge cycles; model is plain data and can be stored in NVM as is.
+
+#define IP5306_CHARGE_PHASE_COUNT 5
+#define IP5306_CHARGE_PHASE_CV 4
+
+struct IP5306_ChargePhaseModel {
+    uint32_t meanMs; // Learned phase duration
+    uint32_t deviationMs; // Mean absolute deviation of the phase duration
+    uint16_t samples; // Number of complete phases observed
+};
+
+struct IP5306_ChargeEstimator {
+    struct IP5306_ChargePhaseModel phases[IP5306_CHARGE_PHASE_COUNT];
+
+    // Charger configuration the model was learned with
+    int chargingCurrent;
+    enum IP5306_BatteryVoltage batteryVoltage;
+    enum IP5306_EndCurrentDetection endCurrentDetection;
+
+    // Current charging session
+    bool charging;
+    bool fullyCharged;
+    int phase;
+    bool phaseTracked; // Phase was entered at its boundary, so its full duration is observed
+    uint32_t phaseStartCycleTime;
+};
+
+struct IP5306_ChargeEstimate {
+    bool valid; // All remaining phases have been learned
+    bool charging;
+    bool fullyCharged;
+    int32_t remainingMs; // Estimated time until full
+    int32_t uncertaintyMs; // Expected error of the estimate
+    int confidence; // 0..100
+};
+
+void IP5306_ChargeEstimatorInit(struct IP5306_ChargeEstimator *estimator, const struct IP5306_ChargerControl *chargerControl);
+void IP5306_ChargeEstimatorSetConfig(struct IP5306_ChargeEstimator *estimator, const struct IP5306_ChargerControl *chargerControl);
+void IP5306_ChargeEstimatorUpdate(struct IP5306_ChargeEstimator *estimator, struct IP5306_Platform *platform,
+    const struct IP5306_Status *status, uint32_t cycleTime); // status must contain READ0, READ1 and READ4
+void IP5306_ChargeEstimatorGetEstimate(struct IP5306_ChargeEstimator *estimator, struct IP5306_Platform *platform,
+    uint32_t cycleTime, struct IP5306_ChargeEstimate *estimate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IP5306_CHARGE_ESTIMATOR_H
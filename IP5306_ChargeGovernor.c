@@ -0,0 +1,200 @@
+#include "IP5306_ChargeGovernor.h"
+
+#define MIN_CHARGING_CURRENT_MA 50
+#define MAX_CHARGING_CURRENT_MA 3150 // 50 + 100 + 200 + 400 + 800 + 1600
+#define CHARGING_CURRENT_STEP_MA 100
+#define DEFAULT_SAG_RECOVERY_MS 5000
+
+
+// Register holds 50 mA + multiples of 100 mA, round down or up to that grid
+static int snapCurrentDown(int current) {
+    return MIN_CHARGING_CURRENT_MA + (current - MIN_CHARGING_CURRENT_MA) / CHARGING_CURRENT_STEP_MA * CHARGING_CURRENT_STEP_MA;
+}
+
+static int snapCurrentUp(int current) {
+    return snapCurrentDown(current + CHARGING_CURRENT_STEP_MA - 1);
+}
+
+static int clampCurrent(struct IP5306_ChargeGovernor *governor, int current) {
+    if (current < governor->config.minCurrent) {
+        current = governor->config.minCurrent;
+    }
+    if (current > governor->config.maxCurrent) {
+        current = governor->config.maxCurrent;
+    }
+
+    return current;
+}
+
+static bool setCurrent(struct IP5306_ChargeGovernor *governor, struct IP5306_Platform *platform, int current) {
+    current = clampCurrent(governor, current);
+    if (current == governor->chargerControl.chargingCurrent) {
+        return true;
+    }
+
+    int prevCurrent = governor->chargerControl.chargingCurrent;
+    governor->chargerControl.chargingCurrent = current;
+    if (!IP5306_WriteChargerControl(platform, &governor->chargerControl, IP5306_CHG_DIG_CTL0_BIT)) {
+        governor->chargerControl.chargingCurrent = prevCurrent;
+        return false;
+    }
+
+    platform->debugPrint("IP5306: Governor changed charging current from %d to %d mA\r\n", prevCurrent, current);
+
+    return true;
+}
+
+bool IP5306_ChargeGovernorInit(struct IP5306_ChargeGovernor *governor, struct IP5306_Platform *platform,
+        const struct IP5306_ChargeGovernorConfig *config) {
+    governor->config = *config;
+
+    if (governor->config.minCurrent < MIN_CHARGING_CURRENT_MA) {
+        governor->config.minCurrent = MIN_CHARGING_CURRENT_MA;
+    }
+    if (governor->config.maxCurrent > MAX_CHARGING_CURRENT_MA) {
+        governor->config.maxCurrent = MAX_CHARGING_CURRENT_MA;
+    }
+    governor->config.minCurrent = snapCurrentUp(governor->config.minCurrent);
+    governor->config.maxCurrent = snapCurrentDown(governor->config.maxCurrent);
+    if (governor->config.maxCurrent < governor->config.minCurrent) {
+        governor->config.minCurrent = governor->config.maxCurrent = snapCurrentDown(governor->config.minCurrent);
+    }
+
+    // Step must keep the current on the grid
+    governor->config.currentStep = (governor->config.currentStep + CHARGING_CURRENT_STEP_MA / 2) /
+        CHARGING_CURRENT_STEP_MA * CHARGING_CURRENT_STEP_MA;
+    if (governor->config.currentStep < CHARGING_CURRENT_STEP_MA) {
+        governor->config.currentStep = CHARGING_CURRENT_STEP_MA;
+    }
+
+    if (governor->config.sagRecoveryMs <= 0) {
+        governor->config.sagRecoveryMs = DEFAULT_SAG_RECOVERY_MS;
+    }
+    // Dropout and recovery are sampled once per step period, so the window must span at least two of them
+    if (governor->config.sagRecoveryMs < 2 * governor->config.stepPeriodMs) {
+        governor->config.sagRecoveryMs = 2 * governor->config.stepPeriodMs;
+    }
+
+    governor->ceiling = governor->config.maxCurrent;
+    governor->charging = false;
+    governor->lastStepCycleTime = platform->invalidCycleTimeValue;
+    governor->backoffCycleTime = platform->invalidCycleTimeValue;
+    governor->dropoutCycleTime = platform->invalidCycleTimeValue;
+    governor->dropoutCurrent = 0;
+    governor->stepUpCount = 0;
+    governor->backoffCount = 0;
+    governor->unplugCount = 0;
+
+    // Read current register contents to preserve reserved bits
+    if (!IP5306_ReadChargerControl(platform, &governor->chargerControl, IP5306_CHARGER_CTL1_BIT | IP5306_CHG_DIG_CTL0_BIT)) {
+        return false;
+    }
+
+    governor->chargerControl.chargingUndervoltageLoop = governor->config.undervoltageLoop;
+    if (!IP5306_WriteChargerControl(platform, &governor->chargerControl, IP5306_CHARGER_CTL1_BIT)) {
+        return false;
+    }
+
+    // Always start from the conservative current
+    governor->chargerControl.chargingCurrent = governor->config.minCurrent;
+    return IP5306_WriteChargerControl(platform, &governor->chargerControl, IP5306_CHG_DIG_CTL0_BIT);
+}
+
+bool IP5306_ChargeGovernorStep(struct IP5306_ChargeGovernor *governor, struct IP5306_Platform *platform, uint32_t cycleTime) {
+    if (!IP5306_IsWorkingState(platform)) {
+        return true;
+    }
+
+    if (governor->lastStepCycleTime != platform->invalidCycleTimeValue &&
+            platform->getTimeDiffMs(cycleTime, governor->lastStepCycleTime) < governor->config.stepPeriodMs) {
+        return true;
+    }
+    governor->lastStepCycleTime = cycleTime;
+
+    // Restore the ceiling once the backoff hold time is over
+    if (governor->backoffCycleTime != platform->invalidCycleTimeValue &&
+            platform->getTimeDiffMs(cycleTime, governor->backoffCycleTime) >= governor->config.backoffHoldMs) {
+        governor->ceiling = governor->config.maxCurrent;
+        governor->backoffCycleTime = platform->invalidCycleTimeValue;
+    }
+
+    struct IP5306_Status status;
+    if (!IP5306_ReadStatus(platform, &status, IP5306_READ0_BIT | IP5306_READ1_BIT | IP5306_READ2_BIT)) {
+        return false;
+    }
+
+    int current = governor->chargerControl.chargingCurrent;
+
+    if (status.fullyCharged) {
+        // Termination is detected by current, no reason to keep high current setting
+        governor->charging = false;
+        return setCurrent(governor, platform, governor->config.minCurrent);
+    }
+
+    if (!status.chargingOn) {
+        if (governor->charging) {
+            // Charging dropped out before full: adapter sag if it resumes soon, unplug otherwise
+            governor->dropoutCycleTime = cycleTime;
+            governor->dropoutCurrent = current;
+        } else if (governor->dropoutCycleTime != platform->invalidCycleTimeValue &&
+                platform->getTimeDiffMs(cycleTime, governor->dropoutCycleTime) >= governor->config.sagRecoveryMs) {
+            // Charger unplugged, the next adapter starts with the full ceiling
+            governor->dropoutCycleTime = platform->invalidCycleTimeValue;
+            governor->ceiling = governor->config.maxCurrent;
+            governor->backoffCycleTime = platform->invalidCycleTimeValue;
+            governor->unplugCount++;
+        }
+
+        governor->charging = false;
+        return setCurrent(governor, platform, governor->config.minCurrent);
+    }
+
+    if (!governor->charging) {
+        if (governor->dropoutCycleTime != platform->invalidCycleTimeValue &&
+                platform->getTimeDiffMs(cycleTime, governor->dropoutCycleTime) < governor->config.sagRecoveryMs &&
+                governor->dropoutCurrent > governor->config.minCurrent) {
+            // Adapter recovered right after dropping out: it could not sustain the current
+            governor->ceiling = clampCurrent(governor, governor->dropoutCurrent - governor->config.currentStep);
+            governor->backoffCycleTime = cycleTime;
+            governor->backoffCount++;
+
+            platform->debugPrint("IP5306: Governor backoff, ceiling %d mA\r\n", governor->ceiling);
+        }
+        governor->dropoutCycleTime = platform->invalidCycleTimeValue;
+
+        // New charging session: hold the starting current for one period to check the adapter
+        governor->charging = true;
+        return true;
+    }
+
+    // Heavy load on the output shares the input, do not raise current until it is gone
+    if (!status.lightLoad) {
+        return true;
+    }
+
+    if (current + governor->config.currentStep <= governor->ceiling) {
+        if (!setCurrent(governor, platform, current + governor->config.currentStep)) {
+            return false;
+        }
+        governor->stepUpCount++;
+    }
+
+    return true;
+}
+
+int32_t IP5306_ChargeGovernorGetNextStepDelayMs(struct IP5306_ChargeGovernor *governor, struct IP5306_Platform *platform, uint32_t cycleTime) {
+    if (!IP5306_IsWorkingState(platform)) {
+        return IP5306_NO_STEP_DEADLINE;
+    }
+
+    if (governor->lastStepCycleTime == platform->invalidCycleTimeValue) {
+        return 0;
+    }
+
+    int32_t elapsed = platform->getTimeDiffMs(cycleTime, governor->lastStepCycleTime);
+    if (elapsed >= governor->config.stepPeriodMs) {
+        return 0;
+    }
+
+    return governor->config.stepPeriodMs - elapsed;
+}
@@ -0,0 +1,54 @@
+#ifndef IP5306_CHARGE_GOVERNOR_H
+#define IP5306_CHARGE_GOVERNOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "IP5306.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// NOTE: Governor ramps CHG_DIG_CTL0 charging current up while the adapter keeps up and backs off when it sags.
+// Chip reports no input voltage and READ0 charging flag drops both when the adapter collapses and when it is unplugged.
+// A sag is detected as charging dropping out while the battery is not full and resuming within sagRecoveryMs
+// (the undervoltage loop throttles first, then charging stops until the adapter recovers); longer dropouts are unplugs.
+// Currents are snapped to the CHG_DIG_CTL0 grid of 50 mA + 100 mA steps.
+
+struct IP5306_ChargeGovernorConfig {
+    int minCurrent; // Starting and fallback charging current (mA)
+    int maxCurrent; // Highest charging current the governor may set (mA)
+    int currentStep; // Current increment per step, multiple of 100 (mA)
+    int stepPeriodMs; // Time charging must stay stable before the next step up
+    int backoffHoldMs; // Time the reduced current ceiling is kept after a sag
+    int sagRecoveryMs; // Longest dropout still treated as a sag, not an unplug; default 5000, at least 2 * stepPeriodMs
+    enum IP5306_ChargingUndervoltageLoop undervoltageLoop; // Undervoltage loop applied on init to protect the adapter
+};
+
+struct IP5306_ChargeGovernor {
+    struct IP5306_ChargeGovernorConfig config;
+    struct IP5306_ChargerControl chargerControl;
+
+    int ceiling; // Highest current the attached adapter is believed to sustain (mA)
+    bool charging; // Charging was observed on the previous step
+    uint32_t lastStepCycleTime;
+    uint32_t backoffCycleTime;
+    uint32_t dropoutCycleTime; // Charging dropped out, not yet known if sag or unplug
+    int dropoutCurrent; // Current set when charging dropped out (mA)
+
+    uint32_t stepUpCount; // Number of current increments
+    uint32_t backoffCount; // Number of backoffs caused by input sag
+    uint32_t unplugCount; // Number of dropouts treated as charger unplug
+};
+
+bool IP5306_ChargeGovernorInit(struct IP5306_ChargeGovernor *governor, struct IP5306_Platform *platform,
+    const struct IP5306_ChargeGovernorConfig *config);
+bool IP5306_ChargeGovernorStep(struct IP5306_ChargeGovernor *governor, struct IP5306_Platform *platform, uint32_t cycleTime);
+int32_t IP5306_ChargeGovernorGetNextStepDelayMs(struct IP5306_ChargeGovernor *governor, struct IP5306_Platform *platform, uint32_t cycleTime);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IP5306_CHARGE_GOVERNOR_H
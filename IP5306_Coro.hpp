@@ -0,0 +1,223 @@
+#ifndef IP5306_CORO_HPP
+#define IP5306_CORO_HPP
+
+// Optional C++20 coroutine layer over the IP5306 driver.
+// Awaitables are resumed from Device::step (call it instead of IP5306_Step, e.g. on every loop tick or IRQ edge)
+// through a user supplied executor. Waiting awaitables are linked into an intrusive list inside the coroutine
+// frame, so no operation allocates memory.
+
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+
+#include "IP5306.h"
+
+namespace ip5306 {
+
+constexpr int32_t NoTimeout = -1;
+
+struct Executor {
+    void (*post)(std::coroutine_handle<> handle, void *context); // Resume handle later from the main loop
+    void *context;
+};
+
+// Fire-and-forget coroutine type for power procedures
+struct Task {
+    struct promise_type {
+        Task get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+class Device;
+
+// Waits until the driver reaches the target state or the timeout expires
+class StateAwaiter {
+public:
+    StateAwaiter(Device &device, IP5306_State state, int32_t timeoutMs) noexcept
+        : device_(device), state_(state), timeoutMs_(timeoutMs) {}
+
+    bool await_ready() const noexcept;
+    void await_suspend(std::coroutine_handle<> handle) noexcept;
+    bool await_resume() const noexcept { return result_; }
+
+protected:
+    friend class Device;
+
+    Device &device_;
+    IP5306_State state_;
+    int32_t timeoutMs_;
+    uint32_t startCycleTime_ = 0;
+    std::coroutine_handle<> handle_;
+    StateAwaiter *next_ = nullptr;
+    bool result_ = false;
+};
+
+// Sends the key gesture and waits for the resulting state
+class TransitionAwaiter : public StateAwaiter {
+public:
+    TransitionAwaiter(Device &device, bool (*start)(IP5306_Platform *), IP5306_State state, int32_t timeoutMs) noexcept
+        : StateAwaiter(device, state, timeoutMs), start_(start) {}
+
+    bool await_ready() const noexcept;
+    bool await_suspend(std::coroutine_handle<> handle) noexcept;
+
+private:
+    bool (*start_)(IP5306_Platform *);
+};
+
+// Yields to the executor, then runs a register operation when resumed
+template <typename Op>
+class OpAwaiter {
+public:
+    OpAwaiter(const Executor &executor, Op op) noexcept : executor_(executor), op_(op) {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) noexcept { executor_.post(handle, executor_.context); }
+    bool await_resume() noexcept { return op_(); }
+
+private:
+    const Executor &executor_;
+    Op op_;
+};
+
+class Device {
+public:
+    Device(IP5306_Platform *platform, Executor executor) noexcept : platform_(platform), executor_(executor) {}
+
+    Device(const Device &) = delete;
+    Device &operator=(const Device &) = delete;
+
+    IP5306_Platform *platform() const noexcept { return platform_; }
+
+    // Steps the driver and resumes coroutines whose state is reached or whose timeout expired
+    void step(uint32_t cycleTime) noexcept {
+        IP5306_Step(platform_, cycleTime);
+
+        StateAwaiter **link = &waiters_;
+        while (*link) {
+            StateAwaiter *waiter = *link;
+
+            bool reached = platform_->state == waiter->state_;
+            bool expired = waiter->timeoutMs_ != NoTimeout &&
+                platform_->getTimeDiffMs(cycleTime, waiter->startCycleTime_) >= waiter->timeoutMs_;
+
+            if (reached || expired) {
+                *link = waiter->next_;
+                waiter->result_ = reached;
+                executor_.post(waiter->handle_, executor_.context);
+            } else {
+                link = &waiter->next_;
+            }
+        }
+    }
+
+    // Combines the driver deadline with the nearest awaiter timeout
+    int32_t getNextStepDelayMs(uint32_t cycleTime) const noexcept {
+        int32_t delay = IP5306_GetNextStepDelayMs(platform_, cycleTime);
+
+        for (const StateAwaiter *waiter = waiters_; waiter; waiter = waiter->next_) {
+            if (waiter->timeoutMs_ == NoTimeout) {
+                continue;
+            }
+
+            int32_t left = waiter->timeoutMs_ - platform_->getTimeDiffMs(cycleTime, waiter->startCycleTime_);
+            if (left < 0) {
+                left = 0;
+            }
+            if (delay == IP5306_NO_STEP_DEADLINE || left < delay) {
+                delay = left;
+            }
+        }
+
+        return delay;
+    }
+
+    StateAwaiter waitState(IP5306_State state, int32_t timeoutMs = NoTimeout) noexcept {
+        return StateAwaiter(*this, state, timeoutMs);
+    }
+
+    TransitionAwaiter wakeUp(int32_t timeoutMs = NoTimeout) noexcept {
+        return TransitionAwaiter(*this, IP5306_WakeUp, IP5306_State_Working, timeoutMs);
+    }
+
+    TransitionAwaiter shutdown(int32_t timeoutMs = NoTimeout) noexcept {
+        return TransitionAwaiter(*this, IP5306_Shutdown, IP5306_State_Sleep, timeoutMs);
+    }
+
+    auto readSystemControl(IP5306_SystemControl &systemControl, unsigned int regBits) noexcept {
+        return makeOp([this, &systemControl, regBits] { return IP5306_ReadSystemControl(platform_, &systemControl, regBits); });
+    }
+
+    auto writeSystemControl(IP5306_SystemControl &systemControl, unsigned int regBits) noexcept {
+        return makeOp([this, &systemControl, regBits] { return IP5306_WriteSystemControl(platform_, &systemControl, regBits); });
+    }
+
+    auto readChargerControl(IP5306_ChargerControl &chargerControl, unsigned int regBits) noexcept {
+        return makeOp([this, &chargerControl, regBits] { return IP5306_ReadChargerControl(platform_, &chargerControl, regBits); });
+    }
+
+    auto writeChargerControl(IP5306_ChargerControl &chargerControl, unsigned int regBits) noexcept {
+        return makeOp([this, &chargerControl, regBits] { return IP5306_WriteChargerControl(platform_, &chargerControl, regBits); });
+    }
+
+    auto readStatus(IP5306_Status &status, unsigned int regBits) noexcept {
+        return makeOp([this, &status, regBits] { return IP5306_ReadStatus(platform_, &status, regBits); });
+    }
+
+    auto writeStatus(IP5306_Status &status) noexcept {
+        return makeOp([this, &status] { return IP5306_WriteStatus(platform_, &status); });
+    }
+
+private:
+    friend class StateAwaiter;
+    friend class TransitionAwaiter;
+
+    template <typename Op>
+    OpAwaiter<Op> makeOp(Op op) noexcept {
+        return OpAwaiter<Op>(executor_, op);
+    }
+
+    void link(StateAwaiter *waiter) noexcept {
+        waiter->startCycleTime_ = platform_->getCycleTime();
+        waiter->next_ = waiters_;
+        waiters_ = waiter;
+    }
+
+    IP5306_Platform *platform_;
+    Executor executor_;
+    StateAwaiter *waiters_ = nullptr;
+};
+
+inline bool StateAwaiter::await_ready() const noexcept {
+    return device_.platform_->state == state_;
+}
+
+inline void StateAwaiter::await_suspend(std::coroutine_handle<> handle) noexcept {
+    handle_ = handle;
+    device_.link(this);
+}
+
+inline bool TransitionAwaiter::await_ready() const noexcept {
+    return false;
+}
+
+inline bool TransitionAwaiter::await_suspend(std::coroutine_handle<> handle) noexcept {
+    // Wrong state for the gesture, resume right away with failure
+    if (!start_(device_.platform_)) {
+        result_ = device_.platform_->state == state_;
+        return false;
+    }
+
+    handle_ = handle;
+    device_.link(this);
+
+    return true;
+}
+
+} // namespace ip5306
+
+#endif // IP5306_CORO_HPP
@@ -0,0 +1,226 @@
+#include "IP5306_KeepAlive.h"
+
+#define SHORTEST_SHUTDOWN_TIME_MS 8000
+#define MAX_MARGIN_MS (SHORTEST_SHUTDOWN_TIME_MS / 2)
+#define MIN_PULSE_INTERVAL_MS 1500 // Two short presses within 1 s are a double press, which turns boost off
+
+
+static int32_t shutdownTimeToMs(enum IP5306_LightLoadShutdownTime shutdownTime) {
+    switch (shutdownTime) {
+    case IP5306_LightLoadShutdownTime_64S:
+        return 64000;
+    case IP5306_LightLoadShutdownTime_32S:
+        return 32000;
+    case IP5306_LightLoadShutdownTime_16S:
+        return 16000;
+    case IP5306_LightLoadShutdownTime_8S:
+    default:
+        return SHORTEST_SHUTDOWN_TIME_MS;
+    }
+}
+
+static int32_t getDeadlineDelayMs(struct IP5306_KeepAlive *keepAlive, struct IP5306_Platform *platform, uint32_t cycleTime) {
+    // Timer start is unknown, act right away
+    if (keepAlive->timerStartCycleTime == platform->invalidCycleTimeValue) {
+        return 0;
+    }
+
+    int32_t delay = keepAlive->shutdownTimeMs - keepAlive->config.marginMs -
+        platform->getTimeDiffMs(cycleTime, keepAlive->timerStartCycleTime);
+
+    if (keepAlive->lastPulseCycleTime != platform->invalidCycleTimeValue) {
+        int32_t pulseDelay = MIN_PULSE_INTERVAL_MS - platform->getTimeDiffMs(cycleTime, keepAlive->lastPulseCycleTime);
+        if (pulseDelay > delay) {
+            delay = pulseDelay;
+        }
+    }
+
+    return delay > 0 ? delay : 0;
+}
+
+static int32_t getPollDelayMs(struct IP5306_KeepAlive *keepAlive, struct IP5306_Platform *platform, uint32_t cycleTime) {
+    if (keepAlive->lastPollCycleTime == platform->invalidCycleTimeValue) {
+        return 0;
+    }
+
+    int32_t delay = keepAlive->config.pollPeriodMs - platform->getTimeDiffMs(cycleTime, keepAlive->lastPollCycleTime);
+
+    return delay > 0 ? delay : 0;
+}
+
+static bool setOutputNormallyOpen(struct IP5306_KeepAlive *keepAlive, struct IP5306_Platform *platform, bool value) {
+    keepAlive->systemControl.outputNormallyOpen = value;
+    if (!IP5306_WriteSystemControl(platform, &keepAlive->systemControl, IP5306_SYS_CTL0_BIT)) {
+        keepAlive->stats.failures++;
+        return false;
+    }
+
+    return true;
+}
+
+static bool readConfig(struct IP5306_KeepAlive *keepAlive, struct IP5306_Platform *platform) {
+    if (!IP5306_ReadSystemControl(platform, &keepAlive->systemControl, IP5306_SYS_CTL_ALL_BITS)) {
+        keepAlive->stats.failures++;
+        return false;
+    }
+
+    // Chip went to sleep before the state was updated, try again after wake up
+    if (keepAlive->systemControl.sysCtl0RegData == IP5306_SLEEPING_ANY_REG_VALUE &&
+            keepAlive->systemControl.sysCtl1RegData == IP5306_SLEEPING_ANY_REG_VALUE &&
+            keepAlive->systemControl.sysCtl2RegData == IP5306_SLEEPING_ANY_REG_VALUE) {
+        return true;
+    }
+
+    keepAlive->shutdownTimeMs = shutdownTimeToMs(keepAlive->systemControl.lightLoadShutdownTime);
+
+    // Value read back while reconfigured is our own
+    if (!keepAlive->reconfigured) {
+        keepAlive->savedOutputNormallyOpen = keepAlive->systemControl.outputNormallyOpen;
+    }
+
+    keepAlive->action = keepAlive->config.action;
+    if (keepAlive->action == IP5306_KeepAliveAction_KeyPulse && keepAlive->systemControl.shortPressSwitchBoostEnable) {
+        platform->debugPrint("IP5306: Keep-alive key pulse would switch boost off, using output normally open\r\n");
+        keepAlive->action = IP5306_KeepAliveAction_OutputNormallyOpen;
+    }
+
+    keepAlive->configKnown = true;
+
+    return true;
+}
+
+bool IP5306_KeepAliveInit(struct IP5306_KeepAlive *keepAlive, struct IP5306_Platform *platform,
+        const struct IP5306_KeepAliveConfig *config) {
+    keepAlive->config = *config;
+
+    // Margin at or above the shutdown time would put the deadline in the past and pulse on every step
+    if (keepAlive->config.marginMs < 0) {
+        keepAlive->config.marginMs = 0;
+    }
+    if (keepAlive->config.marginMs > MAX_MARGIN_MS) {
+        platform->debugPrint("IP5306: Keep-alive margin %d ms limited to %d ms\r\n", keepAlive->config.marginMs, MAX_MARGIN_MS);
+        keepAlive->config.marginMs = MAX_MARGIN_MS;
+    }
+
+    keepAlive->action = config->action;
+    keepAlive->configKnown = false;
+    keepAlive->lightLoad = false;
+    keepAlive->reconfigured = false;
+    keepAlive->savedOutputNormallyOpen = false;
+    keepAlive->timerStartCycleTime = platform->invalidCycleTimeValue;
+    keepAlive->lastPollCycleTime = platform->invalidCycleTimeValue;
+    keepAlive->lastPulseCycleTime = platform->invalidCycleTimeValue;
+    IP5306_KeepAliveResetStats(keepAlive);
+
+    // Shortest shutdown time is assumed until the configured one is known
+    keepAlive->shutdownTimeMs = shutdownTimeToMs(IP5306_LightLoadShutdownTime_8S);
+
+    // Registers are not readable while sleeping, IP5306_KeepAliveStep reads them after wake up
+    if (!IP5306_IsWorkingState(platform)) {
+        return true;
+    }
+
+    return readConfig(keepAlive, platform);
+}
+
+bool IP5306_KeepAliveStep(struct IP5306_KeepAlive *keepAlive, struct IP5306_Platform *platform, uint32_t cycleTime) {
+    if (!IP5306_IsWorkingState(platform)) {
+        // Boost is off anyway, start over after wake up
+        keepAlive->lightLoad = false;
+        keepAlive->timerStartCycleTime = platform->invalidCycleTimeValue;
+        keepAlive->lastPollCycleTime = platform->invalidCycleTimeValue;
+        keepAlive->configKnown = false;
+        return true;
+    }
+
+    // Configuration may have been lost or changed while sleeping
+    if (!keepAlive->configKnown) {
+        if (!readConfig(keepAlive, platform)) {
+            return false;
+        }
+        if (!keepAlive->configKnown) {
+            return true;
+        }
+    }
+
+    if (getPollDelayMs(keepAlive, platform, cycleTime) == 0) {
+        struct IP5306_Status status;
+        if (!IP5306_ReadStatus(platform, &status, IP5306_READ2_BIT)) {
+            keepAlive->stats.failures++;
+            return false;
+        }
+        keepAlive->lastPollCycleTime = cycleTime;
+
+        if (!status.lightLoad) {
+            keepAlive->lightLoad = false;
+            keepAlive->timerStartCycleTime = cycleTime;
+
+            // Load is back, chip can manage boost on its own again
+            if (keepAlive->reconfigured) {
+                if (!setOutputNormallyOpen(keepAlive, platform, keepAlive->savedOutputNormallyOpen)) {
+                    return false;
+                }
+                keepAlive->reconfigured = false;
+            }
+        } else if (!keepAlive->lightLoad) {
+            keepAlive->lightLoad = true;
+            keepAlive->stats.lightLoadEpisodes++;
+        }
+    }
+
+    if (!keepAlive->lightLoad || getDeadlineDelayMs(keepAlive, platform, cycleTime) > 0) {
+        return true;
+    }
+
+    switch (keepAlive->action) {
+    case IP5306_KeepAliveAction_KeyPulse:
+        if (!IP5306_SendShortPress(platform)) {
+            keepAlive->stats.failures++;
+            return false;
+        }
+        keepAlive->stats.keyPulses++;
+        keepAlive->timerStartCycleTime = cycleTime;
+        keepAlive->lastPulseCycleTime = cycleTime;
+        break;
+
+    case IP5306_KeepAliveAction_OutputNormallyOpen:
+        if (!keepAlive->reconfigured) {
+            if (!setOutputNormallyOpen(keepAlive, platform, true)) {
+                return false;
+            }
+            keepAlive->reconfigured = true;
+            keepAlive->stats.reconfigurations++;
+        }
+        break;
+    }
+
+    return true;
+}
+
+int32_t IP5306_KeepAliveGetNextStepDelayMs(struct IP5306_KeepAlive *keepAlive, struct IP5306_Platform *platform, uint32_t cycleTime) {
+    if (!IP5306_IsWorkingState(platform)) {
+        return IP5306_NO_STEP_DEADLINE;
+    }
+
+    if (!keepAlive->configKnown) {
+        return 0;
+    }
+
+    int32_t delay = getPollDelayMs(keepAlive, platform, cycleTime);
+
+    if (keepAlive->lightLoad && !keepAlive->reconfigured) {
+        int32_t deadlineDelay = getDeadlineDelayMs(keepAlive, platform, cycleTime);
+        if (deadlineDelay < delay) {
+            delay = deadlineDelay;
+        }
+    }
+
+    return delay;
+}
+
+void IP5306_KeepAliveResetStats(struct IP5306_KeepAlive *keepAlive) {
+    keepAlive->stats.lightLoadEpisodes = 0;
+    keepAlive->stats.keyPulses = 0;
+    keepAlive->stats.reconfigurations = 0;
+    keepAlive->stats.failures = 0;
+}
@@ -0,0 +1,64 @@
+#ifndef IP5306_KEEP_ALIVE_H
+#define IP5306_KEEP_ALIVE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "IP5306.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// NOTE: Under light load IP5306 turns boost off after the SYS_CTL2 light load shutdown time.
+// Keep-alive tracks the READ2 light load flag and acts shortly before that deadline.
+// The chip timer may start anywhere between two polls, so the deadline is counted from the last heavy load poll.
+// SYS_CTL0..2 are read once the chip is working (a sleeping chip answers 0xEB) and again after every wake up.
+// With SYS_CTL1 short press boost switching enabled a short press would turn boost off, so KeyPulse action
+// falls back to OutputNormallyOpen.
+
+enum IP5306_KeepAliveAction {
+    IP5306_KeepAliveAction_KeyPulse, // Short press before every deadline
+    IP5306_KeepAliveAction_OutputNormallyOpen // Set SYS_CTL0 output normally open until heavy load returns
+};
+
+struct IP5306_KeepAliveConfig {
+    enum IP5306_KeepAliveAction action;
+    int marginMs; // Act this long before the expected shutdown, limited to half of the shortest (8 s) shutdown time
+    int pollPeriodMs; // READ2 poll period, must be well below the margin
+};
+
+struct IP5306_KeepAliveStats {
+    uint32_t lightLoadEpisodes; // Number of heavy to light load changes
+    uint32_t keyPulses; // Number of keep-alive short presses
+    uint32_t reconfigurations; // Number of times output normally open was set
+    uint32_t failures; // Number of failed bus operations or key presses
+};
+
+struct IP5306_KeepAlive {
+    struct IP5306_KeepAliveConfig config;
+    struct IP5306_SystemControl systemControl;
+    struct IP5306_KeepAliveStats stats;
+
+    enum IP5306_KeepAliveAction action; // Action in effect, see the note above
+    bool configKnown; // SYS_CTL0..2 were read while working
+    int32_t shutdownTimeMs;
+    bool lightLoad;
+    bool reconfigured;
+    bool savedOutputNormallyOpen;
+    uint32_t timerStartCycleTime; // Last time light load timer is known to be restarted
+    uint32_t lastPollCycleTime;
+    uint32_t lastPulseCycleTime; // Keep-alive presses are kept out of the double press window
+};
+
+bool IP5306_KeepAliveInit(struct IP5306_KeepAlive *keepAlive, struct IP5306_Platform *platform,
+    const struct IP5306_KeepAliveConfig *config);
+bool IP5306_KeepAliveStep(struct IP5306_KeepAlive *keepAlive, struct IP5306_Platform *platform, uint32_t cycleTime);
+int32_t IP5306_KeepAliveGetNextStepDelayMs(struct IP5306_KeepAlive *keepAlive, struct IP5306_Platform *platform, uint32_t cycleTime);
+void IP5306_KeepAliveResetStats(struct IP5306_KeepAlive *keepAlive);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IP5306_KEEP_ALIVE_H
@@ -0,0 +1,116 @@
+#include "BitOps.h"
+#include "IP5306_Snapshot.h"
+
+#define SNAPSHOT_MAGIC0 0x53
+#define SNAPSHOT_MAGIC1 0x06
+#define SNAPSHOT_CRC_OFFSET (IP5306_SNAPSHOT_SIZE - 2)
+
+#define SYS_CTL_REG_COUNT 3
+#define CHARGER_CTL_REG_COUNT 5
+
+
+static uint16_t crc16(const uint8_t *data, int length) {
+    uint16_t crc = 0xffff;
+
+    for (int i = 0; i < length; i++) {
+        crc ^= (uint16_t)(data[i] << 8);
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+static uint8_t snapshotRegAddr(int index) {
+    return index < SYS_CTL_REG_COUNT ?
+        (uint8_t)(IP5306_REG_SYS_CTL0_ADDR + index) :
+        (uint8_t)(IP5306_REG_CHARGER_CTL0_ADDR + index - SYS_CTL_REG_COUNT);
+}
+
+// Registers of each bank are contiguous, so every bank is read in one burst
+static bool readRegImage(struct IP5306_Platform *platform, uint8_t *regData) {
+    if (!IP5306_ReadRegs(platform, IP5306_REG_SYS_CTL0_ADDR, &regData[0], SYS_CTL_REG_COUNT)) {
+        return false;
+    }
+
+    if (!IP5306_ReadRegs(platform, IP5306_REG_CHARGER_CTL0_ADDR, &regData[SYS_CTL_REG_COUNT], CHARGER_CTL_REG_COUNT)) {
+        return false;
+    }
+
+    // Sleeping chip answers every register with the same value
+    for (int i = 0; i < IP5306_SNAPSHOT_REG_COUNT; i++) {
+        if (regData[i] != IP5306_SLEEPING_ANY_REG_VALUE) {
+            return true;
+        }
+    }
+
+    platform->debugPrint("IP5306: Register image not available, chip is sleeping\r\n");
+    return false;
+}
+
+bool IP5306_SnapshotCapture(struct IP5306_Platform *platform, struct IP5306_Snapshot *snapshot) {
+    return readRegImage(platform, snapshot->regData);
+}
+
+int IP5306_SnapshotSerialize(const struct IP5306_Snapshot *snapshot, uint8_t *buffer, int size) {
+    if (size < IP5306_SNAPSHOT_SIZE) {
+        return -1;
+    }
+
+    buffer[0] = SNAPSHOT_MAGIC0;
+    buffer[1] = SNAPSHOT_MAGIC1;
+    buffer[2] = IP5306_SNAPSHOT_VERSION;
+    for (int i = 0; i < IP5306_SNAPSHOT_REG_COUNT; i++) {
+        buffer[3 + i] = snapshot->regData[i];
+    }
+
+    BITOPS_WRITE_U16L(&buffer[SNAPSHOT_CRC_OFFSET], crc16(buffer, SNAPSHOT_CRC_OFFSET));
+
+    return IP5306_SNAPSHOT_SIZE;
+}
+
+bool IP5306_SnapshotDeserialize(struct IP5306_Snapshot *snapshot, const uint8_t *buffer, int length) {
+    if (length < IP5306_SNAPSHOT_SIZE || buffer[0] != SNAPSHOT_MAGIC0 || buffer[1] != SNAPSHOT_MAGIC1 ||
+            buffer[2] != IP5306_SNAPSHOT_VERSION) {
+        return false;
+    }
+
+    if (BITOPS_READ_U16L(&buffer[SNAPSHOT_CRC_OFFSET]) != crc16(buffer, SNAPSHOT_CRC_OFFSET)) {
+        return false;
+    }
+
+    for (int i = 0; i < IP5306_SNAPSHOT_REG_COUNT; i++) {
+        snapshot->regData[i] = buffer[3 + i];
+    }
+
+    return true;
+}
+
+int IP5306_SnapshotRestore(struct IP5306_Platform *platform, const struct IP5306_Snapshot *snapshot) {
+    uint8_t regData[IP5306_SNAPSHOT_REG_COUNT];
+    int written = 0;
+
+    if (!readRegImage(platform, regData)) {
+        return -1;
+    }
+
+    // Rewrite only registers which differ from the stored image
+    for (int i = 0; i < IP5306_SNAPSHOT_REG_COUNT; i++) {
+        if (regData[i] == snapshot->regData[i]) {
+            continue;
+        }
+
+        if (!IP5306_WriteRegs(platform, snapshotRegAddr(i), &snapshot->regData[i], 1)) {
+            return -1;
+        }
+
+        written++;
+    }
+
+    if (written > 0) {
+        platform->debugPrint("IP5306: Snapshot restored, %d registers rewritten\r\n", written);
+    }
+
+    return written;
+}
@@ -0,0 +1,34 @@
+#ifndef IP5306_SNAPSHOT_H
+#define IP5306_SNAPSHOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "IP5306.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// NOTE: Snapshot holds all writable registers (SYS_CTL0..2, CHARGER_CTL0..3, CHG_DIG_CTL0).
+// Serialized form: magic (2), version (1), registers (8), CRC-16/CCITT little endian (2).
+// Only the current version is accepted. Driver state is not stored, it always comes from the live IRQ pin.
+
+#define IP5306_SNAPSHOT_VERSION 1
+#define IP5306_SNAPSHOT_REG_COUNT 8
+#define IP5306_SNAPSHOT_SIZE 13
+
+struct IP5306_Snapshot {
+    uint8_t regData[IP5306_SNAPSHOT_REG_COUNT]; // In register address order
+};
+
+bool IP5306_SnapshotCapture(struct IP5306_Platform *platform, struct IP5306_Snapshot *snapshot);
+int IP5306_SnapshotSerialize(const struct IP5306_Snapshot *snapshot, uint8_t *buffer, int size);
+bool IP5306_SnapshotDeserialize(struct IP5306_Snapshot *snapshot, const uint8_t *buffer, int length);
+int IP5306_SnapshotRestore(struct IP5306_Platform *platform, const struct IP5306_Snapshot *snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IP5306_SNAPSHOT_H
@@ -0,0 +1,293 @@
+#include "IP5306_StatusFrame.h"
+
+#define STATE_BITS 3
+#define FLAGS_BITS 6
+#define CURRENT_BITS 5
+#define LEVEL_BITS 3
+
+#define GROUP_STATE 0x8
+#define GROUP_FLAGS 0x4
+#define GROUP_CURRENT 0x2
+#define GROUP_LEVEL 0x1
+
+#define MAX_CURRENT_INDEX ((1 << CURRENT_BITS) - 1)
+#define MAX_LEVEL_INDEX 4
+
+struct BitWriter {
+    uint8_t *buffer;
+    int bitPos;
+};
+
+struct BitReader {
+    const uint8_t *buffer;
+    int length;
+    int bitPos;
+};
+
+
+// Caller checks the size up front
+static void putBits(struct BitWriter *writer, unsigned int value, int count) {
+    for (int i = count - 1; i >= 0; i--) {
+        uint8_t *byte = &writer->buffer[writer->bitPos >> 3];
+        int shift = 7 - (writer->bitPos & 7);
+
+        if (shift == 7) {
+            *byte = 0;
+        }
+        *byte |= (uint8_t)(((value >> i) & 1) << shift);
+
+        writer->bitPos++;
+    }
+}
+
+static bool getBits(struct BitReader *reader, int count, unsigned int *value) {
+    if (reader->bitPos + count > reader->length * 8) {
+        return false;
+    }
+
+    *value = 0;
+    for (int i = 0; i < count; i++) {
+        int shift = 7 - (reader->bitPos & 7);
+        *value = (*value << 1) | ((reader->buffer[reader->bitPos >> 3] >> shift) & 1);
+
+        reader->bitPos++;
+    }
+
+    return true;
+}
+
+static unsigned int packFlags(const struct IP5306_StatusFrame *frame) {
+    return (frame->chargingOn ? 0x20u : 0) | (frame->fullyCharged ? 0x10u : 0) | (frame->lightLoad ? 0x08u : 0) |
+        (frame->doubleClick ? 0x04u : 0) | (frame->longPress ? 0x02u : 0) | (frame->shortPress ? 0x01u : 0);
+}
+
+static void unpackFlags(struct IP5306_StatusFrame *frame, unsigned int flags) {
+    frame->chargingOn = flags & 0x20;
+    frame->fullyCharged = flags & 0x10;
+    frame->lightLoad = flags & 0x08;
+    frame->doubleClick = flags & 0x04;
+    frame->longPress = flags & 0x02;
+    frame->shortPress = flags & 0x01;
+}
+
+static unsigned int currentIndex(const struct IP5306_StatusFrame *frame) {
+    int index = (frame->chargingCurrent - 50) / 100;
+    if (index < 0) {
+        return 0;
+    }
+
+    return index > MAX_CURRENT_INDEX ? MAX_CURRENT_INDEX : (unsigned int)index;
+}
+
+static unsigned int levelIndex(const struct IP5306_StatusFrame *frame) {
+    int index = frame->batteryLevel / 25;
+    if (index < 0) {
+        return 0;
+    }
+
+    return index > MAX_LEVEL_INDEX ? MAX_LEVEL_INDEX : (unsigned int)index;
+}
+
+static unsigned int changedGroups(const struct IP5306_StatusFrame *frame, const struct IP5306_StatusFrame *previous) {
+    unsigned int mask = 0;
+
+    if (frame->state != previous->state) {
+        mask |= GROUP_STATE;
+    }
+    if (packFlags(frame) != packFlags(previous)) {
+        mask |= GROUP_FLAGS;
+    }
+    if (currentIndex(frame) != currentIndex(previous)) {
+        mask |= GROUP_CURRENT;
+    }
+    if (levelIndex(frame) != levelIndex(previous)) {
+        mask |= GROUP_LEVEL;
+    }
+
+    return mask;
+}
+
+static int deltaSize(unsigned int mask) {
+    int bits = 16;
+
+    bits += (mask & GROUP_STATE) ? STATE_BITS : 0;
+    bits += (mask & GROUP_FLAGS) ? FLAGS_BITS : 0;
+    bits += (mask & GROUP_CURRENT) ? CURRENT_BITS : 0;
+    bits += (mask & GROUP_LEVEL) ? LEVEL_BITS : 0;
+
+    return (bits + 7) / 8;
+}
+
+void IP5306_StatusFrameFill(struct IP5306_StatusFrame *frame, enum IP5306_State state, const struct IP5306_Status *status,
+        const struct IP5306_ChargerControl *chargerControl, uint8_t sequence) {
+    frame->sequence = sequence;
+    frame->state = state;
+
+    frame->chargingOn = status->chargingOn;
+    frame->fullyCharged = status->fullyCharged;
+    frame->lightLoad = status->lightLoad;
+    frame->doubleClick = status->doubleClick;
+    frame->longPress = status->longPress;
+    frame->shortPress = status->shortPress;
+
+    frame->chargingCurrent = chargerControl->chargingCurrent;
+    frame->batteryLevel = status->batteryLevel;
+}
+
+int IP5306_StatusFrameEncode(const struct IP5306_StatusFrame *frame, const struct IP5306_StatusFrame *previous,
+        uint8_t *buffer, int size) {
+    struct BitWriter writer = { buffer, 0 };
+
+    if ((unsigned int)frame->state > IP5306_State_ShuttingDown) {
+        return -1;
+    }
+
+    // Decoder accepts a delta only right after the previous frame, a gap in sequence needs a full frame
+    unsigned int mask = previous ? changedGroups(frame, previous) : 0;
+    bool delta = previous && frame->sequence == (uint8_t)(previous->sequence + 1) &&
+        deltaSize(mask) < IP5306_STATUS_FRAME_FULL_SIZE;
+    int length = delta ? deltaSize(mask) : IP5306_STATUS_FRAME_FULL_SIZE;
+
+    if (size < length) {
+        return -1;
+    }
+
+    putBits(&writer, IP5306_STATUS_FRAME_VERSION, 3);
+    putBits(&writer, delta, 1);
+
+    if (!delta) {
+        putBits(&writer, (unsigned int)frame->state, STATE_BITS);
+        putBits(&writer, 0, 1);
+        putBits(&writer, frame->sequence, 8);
+        putBits(&writer, packFlags(frame), FLAGS_BITS);
+        putBits(&writer, currentIndex(frame), CURRENT_BITS);
+        putBits(&writer, levelIndex(frame), LEVEL_BITS);
+    } else {
+        putBits(&writer, mask, 4);
+        putBits(&writer, frame->sequence, 8);
+        if (mask & GROUP_STATE) {
+            putBits(&writer, (unsigned int)frame->state, STATE_BITS);
+        }
+        if (mask & GROUP_FLAGS) {
+            putBits(&writer, packFlags(frame), FLAGS_BITS);
+        }
+        if (mask & GROUP_CURRENT) {
+            putBits(&writer, currentIndex(frame), CURRENT_BITS);
+        }
+        if (mask & GROUP_LEVEL) {
+            putBits(&writer, levelIndex(frame), LEVEL_BITS);
+        }
+    }
+
+    // Zero padding
+    if (writer.bitPos & 7) {
+        putBits(&writer, 0, 8 - (writer.bitPos & 7));
+    }
+
+    return length;
+}
+
+bool IP5306_StatusFrameDecode(struct IP5306_StatusFrame *frame, const struct IP5306_StatusFrame *previous,
+        const uint8_t *buffer, int length) {
+    struct BitReader reader = { buffer, length, 0 };
+    struct IP5306_StatusFrame decoded;
+    unsigned int version, delta, mask, value;
+
+    if (!buffer || length < 2 || length > IP5306_STATUS_FRAME_MAX_SIZE) {
+        return false;
+    }
+
+    getBits(&reader, 3, &version);
+    getBits(&reader, 1, &delta);
+    if (version != IP5306_STATUS_FRAME_VERSION) {
+        return false;
+    }
+
+    if (!delta) {
+        if (length != IP5306_STATUS_FRAME_FULL_SIZE) {
+            return false;
+        }
+
+        mask = GROUP_STATE | GROUP_FLAGS | GROUP_CURRENT | GROUP_LEVEL;
+
+        getBits(&reader, STATE_BITS, &value);
+        if (value > IP5306_State_ShuttingDown) {
+            return false;
+        }
+        decoded.state = (enum IP5306_State)value;
+
+        getBits(&reader, 1, &value);
+        if (value != 0) {
+            return false;
+        }
+
+        getBits(&reader, 8, &value);
+        decoded.sequence = (uint8_t)value;
+    } else {
+        getBits(&reader, 4, &mask);
+        if (length != deltaSize(mask) || length >= IP5306_STATUS_FRAME_FULL_SIZE) {
+            return false;
+        }
+
+        getBits(&reader, 8, &value);
+        decoded.sequence = (uint8_t)value;
+
+        // Delta is relative to the frame right before it, a lost frame needs a full one to resync
+        if (!previous || decoded.sequence != (uint8_t)(previous->sequence + 1)) {
+            return false;
+        }
+
+        decoded.state = previous->state;
+        decoded.chargingOn = previous->chargingOn;
+        decoded.fullyCharged = previous->fullyCharged;
+        decoded.lightLoad = previous->lightLoad;
+        decoded.doubleClick = previous->doubleClick;
+        decoded.longPress = previous->longPress;
+        decoded.shortPress = previous->shortPress;
+        decoded.chargingCurrent = previous->chargingCurrent;
+        decoded.batteryLevel = previous->batteryLevel;
+
+        if (mask & GROUP_STATE) {
+            getBits(&reader, STATE_BITS, &value);
+            if (value > IP5306_State_ShuttingDown) {
+                return false;
+            }
+            decoded.state = (enum IP5306_State)value;
+        }
+    }
+
+    // Lengths were checked against the mask, so reads below cannot run past the buffer
+    if (mask & GROUP_FLAGS) {
+        getBits(&reader, FLAGS_BITS, &value);
+        unpackFlags(&decoded, value);
+    }
+
+    if (mask & GROUP_CURRENT) {
+        getBits(&reader, CURRENT_BITS, &value);
+        decoded.chargingCurrent = 50 + (int)value * 100;
+    }
+
+    if (mask & GROUP_LEVEL) {
+        getBits(&reader, LEVEL_BITS, &value);
+        if (value > MAX_LEVEL_INDEX) {
+            return false;
+        }
+        decoded.batteryLevel = (int)value * 25;
+    }
+
+    // Only changed groups may be sent and padding must be zero, so every frame has a single valid encoding
+    if (delta && changedGroups(&decoded, previous) != mask) {
+        return false;
+    }
+
+    while (reader.bitPos < length * 8) {
+        getBits(&reader, 1, &value);
+        if (value != 0) {
+            return false;
+        }
+    }
+
+    *frame = decoded;
+
+    return true;
+}
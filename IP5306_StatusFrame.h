@@ -0,0 +1,59 @@
+#ifndef IP5306_STATUS_FRAME_H
+#define IP5306_STATUS_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "IP5306.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// NOTE: Compact bit-packed status frame for telemetry, fields are packed MSB first. No integrity check,
+// the transport is expected to carry its own CRC.
+// Full frame (4 bytes): version (3), delta = 0 (1), state (3), spare = 0 (1), sequence (8),
+//   flags (6), charging current index (5), battery level index (3), zero padding (2).
+// Delta frame (2..3 bytes, sent only when smaller than a full frame): version (3), delta = 1 (1), changed group mask (4), sequence (8),
+//   then only the changed groups in order: state (3), flags (6), charging current index (5), battery level index (3),
+//   zero padded to a byte. Sequence must follow the previous frame's one and only changed groups may be present,
+//   so every status has exactly one encoding.
+// Flags from MSB: chargingOn, fullyCharged, lightLoad, doubleClick, longPress, shortPress.
+// Charging current index is (mA - 50) / 100, battery level index is percent / 25.
+
+#define IP5306_STATUS_FRAME_VERSION 1
+#define IP5306_STATUS_FRAME_FULL_SIZE 4
+#define IP5306_STATUS_FRAME_MAX_SIZE IP5306_STATUS_FRAME_FULL_SIZE
+
+struct IP5306_StatusFrame {
+    uint8_t sequence;
+    enum IP5306_State state;
+
+    // READ0..3
+    bool chargingOn;
+    bool fullyCharged;
+    bool lightLoad;
+    bool doubleClick;
+    bool longPress;
+    bool shortPress;
+
+    int chargingCurrent; // mA, 50..3150 in steps of 100
+    int batteryLevel; // %, 0, 25, 50, 75 or 100
+};
+
+// status must contain READ0..READ4, chargerControl must contain CHG_DIG_CTL0
+void IP5306_StatusFrameFill(struct IP5306_StatusFrame *frame, enum IP5306_State state, const struct IP5306_Status *status,
+    const struct IP5306_ChargerControl *chargerControl, uint8_t sequence);
+// Encodes a delta against previous when it is not NULL, frame->sequence follows previous->sequence and the delta is
+// smaller than a full frame, otherwise a full frame. Returns length or -1.
+int IP5306_StatusFrameEncode(const struct IP5306_StatusFrame *frame, const struct IP5306_StatusFrame *previous,
+    uint8_t *buffer, int size);
+// previous is needed for delta frames only. frame is left untouched on failure.
+bool IP5306_StatusFrameDecode(struct IP5306_StatusFrame *frame, const struct IP5306_StatusFrame *previous,
+    const uint8_t *buffer, int length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IP5306_STATUS_FRAME_H
@@ -0,0 +1,154 @@
+#include "BitOps.h"
+#include "IP5306_Trace.h"
+
+#define TRACE_MAGIC "IP5306TR"
+#define TRACE_MAGIC_SIZE 8
+
+#define RECORD_TIMESTAMP_OFFSET 0
+#define RECORD_DEVICE_ID_OFFSET 8
+#define RECORD_REG_BITS_OFFSET 12
+#define RECORD_STATE_OFFSET 14
+#define RECORD_REG_DATA_OFFSET 16
+
+
+int IP5306_TraceEncodeHeader(uint8_t *buffer, int size) {
+    if (size < IP5306_TRACE_HEADER_SIZE) {
+        return -1;
+    }
+
+    for (int i = 0; i < IP5306_TRACE_HEADER_SIZE; i++) {
+        buffer[i] = 0;
+    }
+
+    for (int i = 0; i < TRACE_MAGIC_SIZE; i++) {
+        buffer[i] = (uint8_t)TRACE_MAGIC[i];
+    }
+    BITOPS_WRITE_U16L(&buffer[8], IP5306_TRACE_VERSION);
+    BITOPS_WRITE_U16L(&buffer[10], IP5306_TRACE_HEADER_SIZE);
+    BITOPS_WRITE_U16L(&buffer[12], IP5306_TRACE_RECORD_SIZE);
+    BITOPS_WRITE_U16L(&buffer[14], IP5306_REG_COUNT);
+
+    return IP5306_TRACE_HEADER_SIZE;
+}
+
+bool IP5306_TraceDecodeHeader(const uint8_t *buffer, int length) {
+    if (length < IP5306_TRACE_HEADER_SIZE) {
+        return false;
+    }
+
+    for (int i = 0; i < TRACE_MAGIC_SIZE; i++) {
+        if (buffer[i] != (uint8_t)TRACE_MAGIC[i]) {
+            return false;
+        }
+    }
+
+    return BITOPS_READ_U16L(&buffer[8]) == IP5306_TRACE_VERSION &&
+        BITOPS_READ_U16L(&buffer[10]) == IP5306_TRACE_HEADER_SIZE &&
+        BITOPS_READ_U16L(&buffer[12]) == IP5306_TRACE_RECORD_SIZE &&
+        BITOPS_READ_U16L(&buffer[14]) == IP5306_REG_COUNT;
+}
+
+int IP5306_TraceEncodeRecord(const struct IP5306_TraceRecord *record, uint8_t *buffer, int size) {
+    if (size < IP5306_TRACE_RECORD_SIZE) {
+        return -1;
+    }
+
+    BITOPS_WRITE_U64L(&buffer[RECORD_TIMESTAMP_OFFSET], record->timestampMs);
+    BITOPS_WRITE_U32L(&buffer[RECORD_DEVICE_ID_OFFSET], record->deviceId);
+    BITOPS_WRITE_U16L(&buffer[RECORD_REG_BITS_OFFSET], record->regBits);
+    buffer[RECORD_STATE_OFFSET] = record->state;
+    buffer[RECORD_STATE_OFFSET + 1] = 0;
+
+    for (int i = 0; i < IP5306_REG_COUNT; i++) {
+        buffer[RECORD_REG_DATA_OFFSET + i] = record->regData[i];
+    }
+    for (int i = RECORD_REG_DATA_OFFSET + IP5306_REG_COUNT; i < IP5306_TRACE_RECORD_SIZE; i++) {
+        buffer[i] = 0;
+    }
+
+    return IP5306_TRACE_RECORD_SIZE;
+}
+
+bool IP5306_TraceDecodeRecord(struct IP5306_TraceRecord *record, const uint8_t *buffer, int length) {
+    if (length < IP5306_TRACE_RECORD_SIZE) {
+        return false;
+    }
+
+    record->timestampMs = BITOPS_READ_U64L(&buffer[RECORD_TIMESTAMP_OFFSET]);
+    record->deviceId = BITOPS_READ_U32L(&buffer[RECORD_DEVICE_ID_OFFSET]);
+    record->regBits = BITOPS_READ_U16L(&buffer[RECORD_REG_BITS_OFFSET]);
+    record->state = buffer[RECORD_STATE_OFFSET];
+
+    for (int i = 0; i < IP5306_REG_COUNT; i++) {
+        record->regData[i] = buffer[RECORD_REG_DATA_OFFSET + i];
+    }
+
+    return true;
+}
+
+void IP5306_TraceFillRecord(struct IP5306_TraceRecord *record, struct IP5306_Platform *platform,
+        const struct IP5306_SystemControl *systemControl, const struct IP5306_ChargerControl *chargerControl,
+        const struct IP5306_Status *status, unsigned int regBits, uint64_t timestampMs, uint32_t deviceId) {
+    for (int i = 0; i < IP5306_REG_COUNT; i++) {
+        record->regData[i] = 0;
+    }
+
+    if (!systemControl) {
+        regBits &= ~IP5306_SYS_CTL_ALL_BITS;
+    }
+    if (!chargerControl) {
+        regBits &= ~IP5306_CHARGER_CTL_ALL_BITS;
+    }
+    if (!status) {
+        regBits &= ~IP5306_READ_ALL_WITH_LEVEL_BITS;
+    }
+
+    if (systemControl) {
+        record->regData[IP5306_TRACE_SYS_CTL0] = systemControl->sysCtl0RegData;
+        record->regData[IP5306_TRACE_SYS_CTL1] = systemControl->sysCtl1RegData;
+        record->regData[IP5306_TRACE_SYS_CTL2] = systemControl->sysCtl2RegData;
+    }
+
+    if (chargerControl) {
+        record->regData[IP5306_TRACE_CHARGER_CTL0] = chargerControl->chargerCtl0RegData;
+        record->regData[IP5306_TRACE_CHARGER_CTL1] = chargerControl->chargerCtl1RegData;
+        record->regData[IP5306_TRACE_CHARGER_CTL2] = chargerControl->chargerCtl2RegData;
+        record->regData[IP5306_TRACE_CHARGER_CTL3] = chargerControl->chargerCtl3RegData;
+        record->regData[IP5306_TRACE_CHG_DIG_CTL0] = chargerControl->chgDigCtl0RegData;
+    }
+
+    if (status) {
+        record->regData[IP5306_TRACE_READ0] = status->read0RegData;
+        record->regData[IP5306_TRACE_READ1] = status->read1RegData;
+        record->regData[IP5306_TRACE_READ2] = status->read2RegData;
+        record->regData[IP5306_TRACE_READ3] = status->read3RegData;
+        record->regData[IP5306_TRACE_READ4] = status->read4RegData;
+    }
+
+    record->timestampMs = timestampMs;
+    record->deviceId = deviceId;
+    record->regBits = (uint16_t)regBits;
+    record->state = (uint8_t)platform->state;
+}
+
+bool IP5306_TraceWriterBegin(struct IP5306_TraceWriter *writer) {
+    uint8_t buffer[IP5306_TRACE_HEADER_SIZE];
+
+    writer->records = 0;
+    IP5306_TraceEncodeHeader(buffer, sizeof(buffer));
+
+    return writer->write(buffer, sizeof(buffer), writer->context);
+}
+
+bool IP5306_TraceWriterAppend(struct IP5306_TraceWriter *writer, const struct IP5306_TraceRecord *record) {
+    uint8_t buffer[IP5306_TRACE_RECORD_SIZE];
+
+    IP5306_TraceEncodeRecord(record, buffer, sizeof(buffer));
+    if (!writer->write(buffer, sizeof(buffer), writer->context)) {
+        return false;
+    }
+
+    writer->records++;
+
+    return true;
+}
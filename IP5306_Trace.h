@@ -0,0 +1,70 @@
+#ifndef IP5306_TRACE_H
+#define IP5306_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "IP5306.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// NOTE: Register trace file is a 32 byte header followed by fixed size 32 byte records, all little endian,
+// so a file can be memory mapped and split at any record boundary.
+// Header: magic "IP5306TR" (8), version (2), header size (2), record size (2), register count (2), reserved (16).
+// Record: timestamp ms (8), device id (4), valid register bits (2), state (1), reserved (1),
+// register image in register address order (13), reserved (3).
+// Valid register bits use the IP5306_*_BIT masks; bit n corresponds to regData[n].
+
+#define IP5306_TRACE_VERSION 1
+#define IP5306_TRACE_HEADER_SIZE 32
+#define IP5306_TRACE_RECORD_SIZE 32
+
+// Register image indexes, in register address order
+#define IP5306_TRACE_SYS_CTL0 0
+#define IP5306_TRACE_SYS_CTL1 1
+#define IP5306_TRACE_SYS_CTL2 2
+#define IP5306_TRACE_CHARGER_CTL0 3
+#define IP5306_TRACE_CHARGER_CTL1 4
+#define IP5306_TRACE_CHARGER_CTL2 5
+#define IP5306_TRACE_CHARGER_CTL3 6
+#define IP5306_TRACE_CHG_DIG_CTL0 7
+#define IP5306_TRACE_READ0 8
+#define IP5306_TRACE_READ1 9
+#define IP5306_TRACE_READ2 10
+#define IP5306_TRACE_READ3 11
+#define IP5306_TRACE_READ4 12
+
+struct IP5306_TraceRecord {
+    uint64_t timestampMs;
+    uint32_t deviceId;
+    uint16_t regBits; // Registers present in regData
+    uint8_t state; // enum IP5306_State
+    uint8_t regData[IP5306_REG_COUNT];
+};
+
+struct IP5306_TraceWriter {
+    bool (*write)(const uint8_t *data, int length, void *context); // Appends bytes to the trace storage
+    void *context;
+    uint32_t records; // Records written so far
+};
+
+int IP5306_TraceEncodeHeader(uint8_t *buffer, int size);
+bool IP5306_TraceDecodeHeader(const uint8_t *buffer, int length);
+int IP5306_TraceEncodeRecord(const struct IP5306_TraceRecord *record, uint8_t *buffer, int size);
+bool IP5306_TraceDecodeRecord(struct IP5306_TraceRecord *record, const uint8_t *buffer, int length);
+
+// Any of the register structs may be NULL, only registers selected by regBits are taken from them
+void IP5306_TraceFillRecord(struct IP5306_TraceRecord *record, struct IP5306_Platform *platform,
+    const struct IP5306_SystemControl *systemControl, const struct IP5306_ChargerControl *chargerControl,
+    const struct IP5306_Status *status, unsigned int regBits, uint64_t timestampMs, uint32_t deviceId);
+
+bool IP5306_TraceWriterBegin(struct IP5306_TraceWriter *writer);
+bool IP5306_TraceWriterAppend(struct IP5306_TraceWriter *writer, const struct IP5306_TraceRecord *record);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IP5306_TRACE_H
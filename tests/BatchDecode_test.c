@@ -0,0 +1,151 @@
+// Checks the batch decode kernels against scalar reference decoding of every register value,
+// with batch lengths covering the vector loops and the scalar tail.
+
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__AVX2__)
+#define REQUIRE_AVX2 1
+#endif
+
+#include "BitOps.h"
+#include "IP5306_BatchDecode.h"
+
+#define MAX_COUNT 300
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+        failures++; \
+    } \
+} while (0)
+
+// Same mapping as READ4 decoding in IP5306_ReadStatus
+static int referenceBatteryLevel(uint8_t data) {
+    switch (BITOPS_GET_BITS(data, 4, 4)) {
+    case 0x0: return 100;
+    case 0x8: return 75;
+    case 0xc: return 50;
+    case 0xe: return 25;
+    default: return 0;
+    }
+}
+
+static void fillInput(uint8_t *data, size_t count, unsigned int seed) {
+    for (size_t i = 0; i < count; i++) {
+        data[i] = (uint8_t)(i + seed * 37);
+    }
+}
+
+static void testFieldBatch(void) {
+    uint8_t in[MAX_COUNT] = { 0 };
+    uint8_t out[MAX_COUNT];
+
+    for (size_t count = 0; count <= MAX_COUNT; count += (count < 70 ? 1 : 23)) {
+        fillInput(in, count, (unsigned int)count);
+
+        for (int firstBit = 0; firstBit < 8; firstBit++) {
+            for (int bitCount = 1; firstBit + bitCount <= 8; bitCount++) {
+                CHECK(IP5306_DecodeFieldBatch(in, out, count, firstBit, bitCount), "valid field rejected");
+
+                for (size_t i = 0; i < count; i++) {
+                    CHECK(out[i] == BITOPS_GET_BITS(in[i], firstBit, bitCount),
+                        "field %d:%d of 0x%02x: %u", firstBit, bitCount, in[i], out[i]);
+                }
+            }
+        }
+    }
+
+    // Fields crossing the byte are rejected without touching the output
+    memset(out, 0x5a, sizeof(out));
+    fillInput(in, MAX_COUNT, 1);
+    CHECK(!IP5306_DecodeFieldBatch(in, out, MAX_COUNT, 6, 3), "crossing field accepted");
+    CHECK(!IP5306_DecodeFieldBatch(in, out, MAX_COUNT, -1, 2), "negative first bit accepted");
+    CHECK(!IP5306_DecodeFieldBatch(in, out, MAX_COUNT, 0, 0), "empty field accepted");
+    for (size_t i = 0; i < MAX_COUNT; i++) {
+        CHECK(out[i] == 0x5a, "output written for rejected field");
+    }
+}
+
+static void testChargingCurrentBatch(void) {
+    uint8_t in[MAX_COUNT] = { 0 };
+    uint16_t out[MAX_COUNT];
+
+    for (size_t count = 0; count <= MAX_COUNT; count += (count < 70 ? 1 : 23)) {
+        fillInput(in, count, (unsigned int)count + 3);
+        IP5306_DecodeChargingCurrentBatch(in, out, count);
+
+        for (size_t i = 0; i < count; i++) {
+            int expected = 50 + BITOPS_GET_BIT(in[i], 0) * 100 + BITOPS_GET_BIT(in[i], 1) * 200 +
+                BITOPS_GET_BIT(in[i], 2) * 400 + BITOPS_GET_BIT(in[i], 3) * 800 + BITOPS_GET_BIT(in[i], 4) * 1600;
+            CHECK(out[i] == expected, "current of 0x%02x: %u != %d", in[i], out[i], expected);
+        }
+    }
+}
+
+static void testBatteryLevelBatch(void) {
+    uint8_t in[MAX_COUNT] = { 0 };
+    uint8_t out[MAX_COUNT];
+
+    for (size_t count = 0; count <= MAX_COUNT; count += (count < 70 ? 1 : 23)) {
+        fillInput(in, count, (unsigned int)count + 5);
+        IP5306_DecodeBatteryLevelBatch(in, out, count);
+
+        for (size_t i = 0; i < count; i++) {
+            CHECK(out[i] == referenceBatteryLevel(in[i]), "level of 0x%02x: %u", in[i], out[i]);
+        }
+    }
+}
+
+static void testStatusColumns(void) {
+    uint8_t regs[5][256];
+    uint8_t out[7][256];
+
+    for (int r = 0; r < 5; r++) {
+        for (int i = 0; i < 256; i++) {
+            regs[r][i] = (uint8_t)(i * (2 * r + 1));
+        }
+    }
+
+    struct IP5306_StatusColumns columns = {
+        regs[0], regs[1], regs[2], regs[3], regs[4],
+        out[0], out[1], out[2], out[3], out[4], out[5], out[6]
+    };
+    IP5306_DecodeStatusBatch(&columns, 256);
+
+    for (int i = 0; i < 256; i++) {
+        CHECK(out[0][i] == BITOPS_GET_BIT(regs[0][i], 3), "chargingOn");
+        CHECK(out[1][i] == BITOPS_GET_BIT(regs[1][i], 3), "fullyCharged");
+        CHECK(out[2][i] == BITOPS_GET_BIT(regs[2][i], 2), "lightLoad");
+        CHECK(out[3][i] == BITOPS_GET_BIT(regs[3][i], 2), "doubleClick");
+        CHECK(out[4][i] == BITOPS_GET_BIT(regs[3][i], 1), "longPress");
+        CHECK(out[5][i] == BITOPS_GET_BIT(regs[3][i], 0), "shortPress");
+        CHECK(out[6][i] == referenceBatteryLevel(regs[4][i]), "batteryLevel");
+    }
+}
+
+int main(void) {
+#ifdef REQUIRE_AVX2
+    if (!__builtin_cpu_supports("avx2")) {
+        printf("SKIP: CPU has no AVX2\n");
+        return 0;
+    }
+#endif
+
+    testFieldBatch();
+    testChargingCurrentBatch();
+    testBatteryLevelBatch();
+    testStatusColumns();
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,337 @@
+// Checks the BitOps.h functions and bulk variants against the scalar macros and measures bulk throughput.
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "BitOps.h"
+
+#define ARRAY_COUNT 1027 // Odd, so vector loops end with a scalar tail
+#define THROUGHPUT_COUNT (1 << 16)
+#define THROUGHPUT_ROUNDS 200
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+        failures++; \
+    } \
+} while (0)
+
+static uint64_t randomState = 0x9e3779b97f4a7c15ull;
+
+static uint64_t random64(void) {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 7;
+    randomState ^= randomState << 17;
+    return randomState;
+}
+
+static void fillRandom(void *data, size_t size) {
+    uint8_t *bytes = (uint8_t *)data;
+    for (size_t i = 0; i < size; i++) {
+        bytes[i] = (uint8_t)random64();
+    }
+}
+
+static int64_t referenceSigned(uint64_t field, unsigned bn) {
+    if (bn < 64 && (field >> (bn - 1)) & 1) {
+        return (int64_t)field - (int64_t)(1ull << (bn - 1)) - (int64_t)(1ull << (bn - 1));
+    }
+    return (int64_t)field;
+}
+
+static void testMasks(void) {
+    CHECK(BitOps_Mask32(0) == 0, "Mask32(0)");
+    CHECK(BitOps_Mask32(32) == 0xffffffffu, "Mask32(32)");
+    CHECK(BitOps_Mask64(0) == 0, "Mask64(0)");
+    CHECK(BitOps_Mask64(64) == 0xffffffffffffffffull, "Mask64(64)");
+
+    for (unsigned bn = 1; bn < 32; bn++) {
+        CHECK(BitOps_Mask32(bn) == BITOPS_GET_BITS(0xffffffffu, 0, bn), "Mask32(%u)", bn);
+    }
+    for (unsigned bn = 1; bn < 64; bn++) {
+        CHECK(BitOps_Mask64(bn) == BITOPS_GET_BITS_64(0xffffffffffffffffull, 0, bn), "Mask64(%u)", bn);
+    }
+}
+
+static void testFields(void) {
+    for (int round = 0; round < 200; round++) {
+        uint64_t value64 = random64();
+        uint32_t value32 = (uint32_t)value64;
+        uint64_t newValue = random64();
+
+        for (unsigned b1 = 0; b1 < 32; b1++) {
+            for (unsigned bn = 1; b1 + bn <= 32; bn++) {
+                if (bn < 32) {
+                    CHECK(BitOps_GetBits32(value32, b1, bn) == BITOPS_GET_BITS(value32, b1, bn),
+                        "GetBits32(0x%08x, %u, %u)", (unsigned)value32, b1, bn);
+
+                    unsigned int expected = value32;
+                    BITOPS_SET_BITS(&expected, b1, bn, (uint32_t)newValue);
+                    CHECK(BitOps_SetBits32(value32, b1, bn, (uint32_t)newValue) == expected,
+                        "SetBits32(0x%08x, %u, %u)", (unsigned)value32, b1, bn);
+
+                    int32_t signedValue = BitOps_GetSignedBits32(value32, b1, bn);
+                    CHECK(signedValue == referenceSigned(BITOPS_GET_BITS(value32, b1, bn), bn),
+                        "GetSignedBits32(0x%08x, %u, %u) = %ld", (unsigned)value32, b1, bn, (long)signedValue);
+                    CHECK(signedValue == BITOPS_GET_SIGNED_BITS(value32, b1, bn),
+                        "BITOPS_GET_SIGNED_BITS(0x%08x, %u, %u)", (unsigned)value32, b1, bn);
+                } else {
+                    CHECK(BitOps_GetBits32(value32, 0, 32) == value32, "GetBits32 full width");
+                    CHECK(BitOps_GetSignedBits32(value32, 0, 32) == (int32_t)value32, "GetSignedBits32 full width");
+                }
+            }
+        }
+
+        for (unsigned b1 = 0; b1 < 64; b1 += 3) {
+            for (unsigned bn = 1; b1 + bn < 64; bn++) {
+                CHECK(BitOps_GetBits64(value64, b1, bn) == BITOPS_GET_BITS_64(value64, b1, bn),
+                    "GetBits64(%u, %u)", b1, bn);
+
+                unsigned long long expected = value64;
+                BITOPS_SET_BITS_64(&expected, b1, bn, newValue);
+                CHECK(BitOps_SetBits64(value64, b1, bn, newValue) == expected, "SetBits64(%u, %u)", b1, bn);
+
+                int64_t signedValue = BitOps_GetSignedBits64(value64, b1, bn);
+                CHECK(signedValue == referenceSigned(BITOPS_GET_BITS_64(value64, b1, bn), bn),
+                    "GetSignedBits64(%u, %u)", b1, bn);
+                CHECK(signedValue == BITOPS_GET_SIGNED_BITS_64(value64, b1, bn),
+                    "BITOPS_GET_SIGNED_BITS_64(%u, %u)", b1, bn);
+            }
+        }
+    }
+
+    // Negative branch of the macros returned -(|v| - 2) before the fix
+    CHECK(BITOPS_GET_SIGNED_BITS(0x7u, 0, 3) == -1, "3-bit -1");
+    CHECK(BITOPS_GET_SIGNED_BITS(0x4u, 0, 3) == -4, "3-bit -4");
+    CHECK(BITOPS_GET_SIGNED_BITS(0x3u, 0, 3) == 3, "3-bit 3");
+    CHECK(BITOPS_GET_SIGNED_BITS(0xe0u, 5, 3) == -1, "shifted -1");
+    CHECK(BITOPS_GET_SIGNED_BITS(0x80000000u, 16, 16) == -32768, "16-bit minimum");
+    CHECK(BITOPS_GET_SIGNED_BITS_64(0xffffffffffffffffull, 0, 40) == -1, "40-bit -1");
+    CHECK(BITOPS_UINT8_TO_INT8((uint8_t)0x1f, 5) == -1, "UINT8_TO_INT8 5-bit");
+    CHECK(BITOPS_UINT16_TO_INT16((uint16_t)0x0800, 12) == -2048, "UINT16_TO_INT16 12-bit");
+    CHECK(BITOPS_UINT32_TO_INT32((uint32_t)0xffffffffu, 32) == -1, "UINT32_TO_INT32 full width");
+
+    // Results are unsigned, bit 31 is defined
+    CHECK(BITOPS_GET_BITS(0x80000000u, 31, 1) == 1u, "GET_BITS bit 31");
+    CHECK(BITOPS_GET_BITS(0xffffffffu, 1, 31) == 0x7fffffffu, "GET_BITS 31 bits");
+}
+
+static void testScalarEndian(void) {
+    const uint8_t bytes[8] = { 0x80, 0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xff };
+
+    CHECK(BitOps_Bswap16(0x1234) == 0x3412, "Bswap16");
+    CHECK(BitOps_Bswap32(0x12345678u) == 0x78563412u, "Bswap32");
+    CHECK(BitOps_Bswap64(0x0123456789abcdefull) == 0xefcdab8967452301ull, "Bswap64");
+
+    // Top byte with bit 7 set was shifted as int before the fix
+    CHECK(BITOPS_READ_U32B(bytes) == 0x80123456u, "READ_U32B");
+    CHECK(BITOPS_READ_U32L(bytes) == 0x56341280u, "READ_U32L");
+    CHECK(BITOPS_READ_U32B(&bytes[4]) == 0x789abcffu, "READ_U32B high");
+    CHECK(BITOPS_READ_U32L(&bytes[4]) == 0xffbc9a78u, "READ_U32L high");
+
+    CHECK(BitOps_ReadU16B(bytes) == BITOPS_READ_U16B(bytes), "ReadU16B");
+    CHECK(BitOps_ReadU16L(bytes) == BITOPS_READ_U16L(bytes), "ReadU16L");
+    CHECK(BitOps_ReadU32B(bytes) == BITOPS_READ_U32B(bytes), "ReadU32B");
+    CHECK(BitOps_ReadU32L(bytes) == BITOPS_READ_U32L(bytes), "ReadU32L");
+    CHECK(BitOps_ReadU64B(bytes) == 0x80123456789abcffull, "ReadU64B");
+    CHECK(BitOps_ReadU64L(bytes) == 0xffbc9a7856341280ull, "ReadU64L");
+    CHECK(BitOps_ReadU64B(bytes) == BITOPS_READ_U64B(bytes), "ReadU64B macro");
+    CHECK(BitOps_ReadU64L(bytes) == BITOPS_READ_U64L(bytes), "ReadU64L macro");
+
+    for (int round = 0; round < 1000; round++) {
+        uint64_t value = random64();
+        uint8_t expected[8];
+        uint8_t actual[8];
+
+        BITOPS_WRITE_U16B(expected, (uint16_t)value);
+        BitOps_WriteU16B(actual, (uint16_t)value);
+        CHECK(memcmp(expected, actual, 2) == 0, "WriteU16B");
+        BITOPS_WRITE_U16L(expected, (uint16_t)value);
+        BitOps_WriteU16L(actual, (uint16_t)value);
+        CHECK(memcmp(expected, actual, 2) == 0, "WriteU16L");
+
+        BITOPS_WRITE_U32B(expected, (uint32_t)value);
+        BitOps_WriteU32B(actual, (uint32_t)value);
+        CHECK(memcmp(expected, actual, 4) == 0, "WriteU32B");
+        CHECK(BitOps_ReadU32B(actual) == (uint32_t)value, "U32B round trip");
+        BITOPS_WRITE_U32L(expected, (uint32_t)value);
+        BitOps_WriteU32L(actual, (uint32_t)value);
+        CHECK(memcmp(expected, actual, 4) == 0, "WriteU32L");
+        CHECK(BitOps_ReadU32L(actual) == (uint32_t)value, "U32L round trip");
+
+        BITOPS_WRITE_U64B(expected, value);
+        BitOps_WriteU64B(actual, value);
+        CHECK(memcmp(expected, actual, 8) == 0, "WriteU64B");
+        CHECK(BitOps_ReadU64B(actual) == value, "U64B round trip");
+        BITOPS_WRITE_U64L(expected, value);
+        BitOps_WriteU64L(actual, value);
+        CHECK(memcmp(expected, actual, 8) == 0, "WriteU64L");
+        CHECK(BitOps_ReadU64L(actual) == value, "U64L round trip");
+    }
+}
+
+static void testArrays(void) {
+    static uint8_t bytes[ARRAY_COUNT * 8];
+    static uint16_t array16[ARRAY_COUNT];
+    static uint32_t array32[ARRAY_COUNT];
+    static uint64_t array64[ARRAY_COUNT];
+    static uint8_t out8[ARRAY_COUNT];
+    static uint16_t out16[ARRAY_COUNT];
+    static uint32_t out32[ARRAY_COUNT];
+    static uint64_t out64[ARRAY_COUNT];
+
+    fillRandom(bytes, sizeof(bytes));
+
+    for (size_t n = 0; n <= ARRAY_COUNT; n += (n < 40 ? 1 : 97)) {
+        BitOps_ReadArrayU16B(array16, bytes, n);
+        BitOps_ReadArrayU16L(out16, bytes, n);
+        for (size_t k = 0; k < n; k++) {
+            CHECK(array16[k] == BITOPS_READ_U16B(&bytes[2 * k]), "ReadArrayU16B[%zu]", k);
+            CHECK(out16[k] == BITOPS_READ_U16L(&bytes[2 * k]), "ReadArrayU16L[%zu]", k);
+        }
+        BitOps_BswapArray16(out16, n);
+        CHECK(memcmp(out16, array16, n * 2) == 0, "BswapArray16 n=%zu", n);
+
+        BitOps_ReadArrayU32B(array32, bytes, n);
+        BitOps_ReadArrayU32L(out32, bytes, n);
+        for (size_t k = 0; k < n; k++) {
+            CHECK(array32[k] == BITOPS_READ_U32B(&bytes[4 * k]), "ReadArrayU32B[%zu]", k);
+            CHECK(out32[k] == BITOPS_READ_U32L(&bytes[4 * k]), "ReadArrayU32L[%zu]", k);
+        }
+        BitOps_BswapArray32(out32, n);
+        CHECK(memcmp(out32, array32, n * 4) == 0, "BswapArray32 n=%zu", n);
+
+        BitOps_ReadArrayU64B(array64, bytes, n);
+        BitOps_ReadArrayU64L(out64, bytes, n);
+        for (size_t k = 0; k < n; k++) {
+            CHECK(array64[k] == BITOPS_READ_U64B(&bytes[8 * k]), "ReadArrayU64B[%zu]", k);
+            CHECK(out64[k] == BITOPS_READ_U64L(&bytes[8 * k]), "ReadArrayU64L[%zu]", k);
+        }
+        BitOps_BswapArray64(out64, n);
+        CHECK(memcmp(out64, array64, n * 8) == 0, "BswapArray64 n=%zu", n);
+    }
+
+    fillRandom(array16, sizeof(array16));
+    fillRandom(array32, sizeof(array32));
+    fillRandom(array64, sizeof(array64));
+
+    for (unsigned b1 = 0; b1 < 64; b1++) {
+        for (unsigned bn = 1; b1 + bn <= 64; bn++) {
+            if (b1 + bn <= 8) {
+                BitOps_GetBitsArray8(out8, bytes, ARRAY_COUNT, b1, bn);
+                for (size_t k = 0; k < ARRAY_COUNT; k++) {
+                    CHECK(out8[k] == BITOPS_GET_BITS(bytes[k], b1, bn), "GetBitsArray8(%u, %u)[%zu]", b1, bn, k);
+                }
+            }
+            if (b1 + bn <= 16) {
+                BitOps_GetBitsArray16(out16, array16, ARRAY_COUNT, b1, bn);
+                for (size_t k = 0; k < ARRAY_COUNT; k++) {
+                    CHECK(out16[k] == BITOPS_GET_BITS(array16[k], b1, bn), "GetBitsArray16(%u, %u)[%zu]", b1, bn, k);
+                }
+            }
+            if (b1 + bn < 32) {
+                BitOps_GetBitsArray32(out32, array32, ARRAY_COUNT, b1, bn);
+                for (size_t k = 0; k < ARRAY_COUNT; k++) {
+                    CHECK(out32[k] == BITOPS_GET_BITS(array32[k], b1, bn), "GetBitsArray32(%u, %u)[%zu]", b1, bn, k);
+                }
+            }
+            if (bn < 64) {
+                BitOps_GetBitsArray64(out64, array64, ARRAY_COUNT, b1, bn);
+                for (size_t k = 0; k < ARRAY_COUNT; k++) {
+                    CHECK(out64[k] == BITOPS_GET_BITS_64(array64[k], b1, bn), "GetBitsArray64(%u, %u)[%zu]", b1, bn, k);
+                }
+            }
+        }
+    }
+
+    BitOps_GetBitsArray32(out32, array32, ARRAY_COUNT, 0, 32);
+    CHECK(memcmp(out32, array32, sizeof(array32)) == 0, "GetBitsArray32 full width");
+    BitOps_GetBitsArray64(out64, array64, ARRAY_COUNT, 0, 64);
+    CHECK(memcmp(out64, array64, sizeof(array64)) == 0, "GetBitsArray64 full width");
+}
+
+static double elapsedSeconds(clock_t start) {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void printThroughput(const char *name, size_t bytes, double macroSeconds, double bulkSeconds) {
+    double megabytes = (double)bytes * THROUGHPUT_ROUNDS / 1e6;
+    printf("  %-16s macro %8.0f MB/s, bulk %8.0f MB/s\n", name,
+        macroSeconds > 0 ? megabytes / macroSeconds : 0.0, bulkSeconds > 0 ? megabytes / bulkSeconds : 0.0);
+}
+
+// Per-element macro loop against the bulk function on the same data, results only printed
+static void measureThroughput(void) {
+    static uint8_t bytes[THROUGHPUT_COUNT * 4];
+    static uint32_t out32[THROUGHPUT_COUNT];
+    static uint8_t out8[THROUGHPUT_COUNT * 4];
+    volatile uint32_t sink = 0;
+    clock_t start;
+
+    fillRandom(bytes, sizeof(bytes));
+    printf("Throughput (%d elements x %d rounds):\n", THROUGHPUT_COUNT, THROUGHPUT_ROUNDS);
+
+    start = clock();
+    for (int round = 0; round < THROUGHPUT_ROUNDS; round++) {
+        bytes[round] ^= 1;
+        for (size_t k = 0; k < THROUGHPUT_COUNT; k++) {
+            out32[k] = BITOPS_READ_U32B(&bytes[4 * k]);
+        }
+        sink += out32[round];
+    }
+    double macroSeconds = elapsedSeconds(start);
+
+    start = clock();
+    for (int round = 0; round < THROUGHPUT_ROUNDS; round++) {
+        bytes[round] ^= 1;
+        BitOps_ReadArrayU32B(out32, bytes, THROUGHPUT_COUNT);
+        sink += out32[round];
+    }
+    printThroughput("ReadArrayU32B", sizeof(bytes), macroSeconds, elapsedSeconds(start));
+
+    start = clock();
+    for (int round = 0; round < THROUGHPUT_ROUNDS; round++) {
+        bytes[round] ^= 1;
+        for (size_t k = 0; k < sizeof(bytes); k++) {
+            out8[k] = (uint8_t)BITOPS_GET_BITS(bytes[k], 2, 3);
+        }
+        sink += out8[round];
+    }
+    macroSeconds = elapsedSeconds(start);
+
+    start = clock();
+    for (int round = 0; round < THROUGHPUT_ROUNDS; round++) {
+        bytes[round] ^= 1;
+        BitOps_GetBitsArray8(out8, bytes, sizeof(bytes), 2, 3);
+        sink += out8[round];
+    }
+    printThroughput("GetBitsArray8", sizeof(bytes), macroSeconds, elapsedSeconds(start));
+
+    (void)sink;
+}
+
+int main(int argc, char **argv) {
+    testMasks();
+    testFields();
+    testScalarEndian();
+    testArrays();
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+
+    printf("OK\n");
+
+    // Timing is informative only, skipped with --no-throughput
+    if (argc < 2 || strcmp(argv[1], "--no-throughput") != 0) {
+        measureThroughput();
+    }
+
+    return 0;
+}
@@ -0,0 +1,211 @@
+// Bus scheduler: priority, then deadline, then submit order, per-device settle slots and per-class statistics.
+
+#include <stdio.h>
+
+#include "MockPlatform.h"
+#include "IP5306_BusScheduler.h"
+
+#define FAILING_ADDR 0x7f
+#define MAX_TRANSFERS 32
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+        failures++; \
+    } \
+} while (0)
+
+static struct IP5306_Platform platform;
+static struct IP5306_BusScheduler scheduler;
+
+// Device addresses in the order the bus saw them
+static uint8_t transferAddrs[MAX_TRANSFERS];
+static int transferCount;
+
+static int recordWriteReg(uint8_t addr7bit, uint8_t regNum, const uint8_t *data, uint8_t length, uint8_t wait) {
+    if (transferCount < MAX_TRANSFERS) {
+        transferAddrs[transferCount++] = addr7bit;
+    }
+    if (addr7bit == FAILING_ADDR) {
+        mockTime += 1;
+        return -1;
+    }
+
+    return mockWriteReg(addr7bit, regNum, data, length, wait);
+}
+
+static int recordReadReg(uint8_t addr7bit, uint8_t regNum, uint8_t *data, uint8_t length, int timeout) {
+    if (transferCount < MAX_TRANSFERS) {
+        transferAddrs[transferCount++] = addr7bit;
+    }
+    if (addr7bit == FAILING_ADDR) {
+        mockTime += 1;
+        return -1;
+    }
+
+    return mockReadReg(addr7bit, regNum, data, length, timeout);
+}
+
+static void setup(void) {
+    mockPlatformInit(&platform);
+    platform.i2cWriteReg = recordWriteReg;
+    platform.i2cReadReg = recordReadReg;
+    transferCount = 0;
+
+    IP5306_BusSchedulerInit(&scheduler, &platform);
+}
+
+static bool submit(uint8_t addr7bit, bool write, uint8_t priority, int32_t deadlineMs, uint8_t busClass, int settleMs) {
+    struct IP5306_BusTransaction transaction;
+    memset(&transaction, 0, sizeof(transaction));
+
+    transaction.busClass = busClass;
+    transaction.priority = priority;
+    transaction.addr7bit = addr7bit;
+    transaction.regNum = 0x70;
+    transaction.write = write;
+    transaction.length = 1;
+    transaction.settleMs = settleMs;
+    transaction.deadlineMs = deadlineMs;
+
+    return IP5306_BusSchedulerSubmit(&scheduler, &transaction, mockTime);
+}
+
+static int pollAll(void) {
+    int count = 0;
+    while (IP5306_BusSchedulerPoll(&scheduler, mockTime)) {
+        count++;
+    }
+
+    return count;
+}
+
+static void testOrdering(void) {
+    setup();
+
+    // Submitted at the same time, so deadline left ties only for equal deadlines
+    submit(0x10, false, 1, IP5306_BUS_NO_DEADLINE, 0, 0);
+    submit(0x11, false, 2, IP5306_BUS_NO_DEADLINE, 0, 0);
+    submit(0x12, false, 1, 50, 0, 0);
+    submit(0x13, false, 1, 50, 0, 0);
+    submit(0x14, false, 1, 20, 0, 0);
+    submit(0x15, false, 0, 1, 0, 0);
+
+    CHECK(pollAll() == 6, "all transactions run");
+
+    static const uint8_t expected[] = { 0x11, 0x14, 0x12, 0x13, 0x10, 0x15 };
+    for (int i = 0; i < 6; i++) {
+        CHECK(transferAddrs[i] == expected[i], "transfer %d: 0x%02x, expected 0x%02x", i, transferAddrs[i], expected[i]);
+    }
+}
+
+static void testDeviceOrder(void) {
+    setup();
+
+    // Higher priority transaction of the same device still waits for the earlier one
+    submit(0x20, false, 0, IP5306_BUS_NO_DEADLINE, 0, 0);
+    submit(0x21, false, 1, IP5306_BUS_NO_DEADLINE, 0, 0);
+    submit(0x20, false, 3, 1, 0, 0);
+
+    CHECK(pollAll() == 3, "all transactions run");
+    CHECK(transferAddrs[0] == 0x21 && transferAddrs[1] == 0x20 && transferAddrs[2] == 0x20,
+        "order 0x%02x 0x%02x 0x%02x", transferAddrs[0], transferAddrs[1], transferAddrs[2]);
+}
+
+static void testSettle(void) {
+    setup();
+
+    CHECK(IP5306_BusSchedulerGetNextPollDelayMs(&scheduler, mockTime) == IP5306_BUS_NO_DEADLINE, "empty queue has no deadline");
+
+    submit(0x75, true, 1, IP5306_BUS_NO_DEADLINE, 0, IP5306_BUS_WRITE_SETTLE_MS);
+    submit(0x75, false, 1, IP5306_BUS_NO_DEADLINE, 0, 0);
+    submit(0x30, false, 0, IP5306_BUS_NO_DEADLINE, 0, 0);
+
+    // Write runs without blocking, the other device uses the bus while the IP5306 settles
+    uint32_t start = mockTime;
+    CHECK(pollAll() == 2, "write and other device run");
+    CHECK(transferAddrs[0] == 0x75 && transferAddrs[1] == 0x30, "order 0x%02x 0x%02x", transferAddrs[0], transferAddrs[1]);
+    CHECK(mockTime - start == 2, "no blocking wait, took %u ms", (unsigned)(mockTime - start));
+
+    int32_t delay = IP5306_BusSchedulerGetNextPollDelayMs(&scheduler, mockTime);
+    CHECK(delay > 0 && delay <= IP5306_BUS_WRITE_SETTLE_MS, "settle delay %d", (int)delay);
+
+    mockDelayMs(delay - 1);
+    CHECK(!IP5306_BusSchedulerPoll(&scheduler, mockTime), "device still settling");
+
+    mockDelayMs(1);
+    CHECK(IP5306_BusSchedulerGetNextPollDelayMs(&scheduler, mockTime) == 0, "read is runnable");
+    CHECK(pollAll() == 1 && transferAddrs[2] == 0x75, "read runs after settle");
+    CHECK(IP5306_BusSchedulerGetNextPollDelayMs(&scheduler, mockTime) == IP5306_BUS_NO_DEADLINE, "queue drained");
+}
+
+static void testSettleSlotsFull(void) {
+    setup();
+
+    for (int i = 0; i <= IP5306_BUS_SETTLE_SLOTS; i++) {
+        submit((uint8_t)(0x40 + i), true, 0, IP5306_BUS_NO_DEADLINE, 0, 10);
+    }
+
+    // One write more than slots: the last one falls back to a blocking wait
+    uint32_t start = mockTime;
+    CHECK(pollAll() == IP5306_BUS_SETTLE_SLOTS + 1, "all writes run");
+    CHECK(mockTime - start == IP5306_BUS_SETTLE_SLOTS + 1 + 10, "blocking wait for the last write, took %u ms",
+        (unsigned)(mockTime - start));
+}
+
+static void testStats(void) {
+    setup();
+
+    submit(0x50, false, 0, IP5306_BUS_NO_DEADLINE, 1, 0);
+    submit(0x51, false, 0, 5, 2, 0);
+    mockDelayMs(10);
+    submit(0x52, false, 0, 5, 2, 0);
+    submit(FAILING_ADDR, false, 0, IP5306_BUS_NO_DEADLINE, 3, 0);
+
+    CHECK(pollAll() == 4, "all transactions run");
+
+    const struct IP5306_BusClassStats *stats = scheduler.stats;
+    CHECK(stats[0].count == 0, "class 0 unused");
+
+    CHECK(stats[1].count == 1 && stats[1].failures == 0 && stats[1].deadlineMisses == 0, "class 1 counts");
+    CHECK(stats[1].maxLatencyMs >= 10 && stats[1].totalLatencyMs == (uint64_t)stats[1].maxLatencyMs,
+        "class 1 latency %d total %u", (int)stats[1].maxLatencyMs, (unsigned)stats[1].totalLatencyMs);
+
+    // First one waited past its deadline, second one ran in time
+    CHECK(stats[2].count == 2 && stats[2].deadlineMisses == 1, "class 2 count %u misses %u",
+        (unsigned)stats[2].count, (unsigned)stats[2].deadlineMisses);
+    CHECK(stats[2].maxLatencyMs >= 10 && stats[2].totalLatencyMs > (uint64_t)stats[2].maxLatencyMs,
+        "class 2 latency %d total %u", (int)stats[2].maxLatencyMs, (unsigned)stats[2].totalLatencyMs);
+
+    CHECK(stats[3].count == 1 && stats[3].failures == 1, "class 3 failure counted");
+
+    struct IP5306_BusTransaction transaction;
+    memset(&transaction, 0, sizeof(transaction));
+    transaction.busClass = IP5306_BUS_CLASS_COUNT;
+    CHECK(!IP5306_BusSchedulerSubmit(&scheduler, &transaction, mockTime), "invalid class rejected");
+
+    IP5306_BusSchedulerResetStats(&scheduler);
+    for (int i = 0; i < IP5306_BUS_CLASS_COUNT; i++) {
+        CHECK(stats[i].count == 0 && stats[i].totalLatencyMs == 0 && stats[i].maxLatencyMs == 0, "class %d reset", i);
+    }
+}
+
+int main(void) {
+    testOrdering();
+    testDeviceOrder();
+    testSettle();
+    testSettleSlotsFull();
+    testStats();
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,167 @@
+// Charge governor against a simulated adapter: ramp-up to the adapter limit, sag backoff, unplug vs. sag
+// classification (sagRecoveryMs) and full charge.
+
+#include <stdio.h>
+
+#include "MockPlatform.h"
+#include "IP5306_ChargeGovernor.h"
+
+#define TICK_MS 1000
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+        failures++; \
+    } \
+} while (0)
+
+// Adapter collapses when asked for more than it can deliver: charging stops until it recovers
+struct Adapter {
+    bool plugged;
+    int limitMa;
+    int recoveryMs;
+    uint32_t sagEndTime; // 0 when not sagging
+    int batteryMah; // Charge left to full
+    int64_t chargedUah; // Charge delivered in the current session, uA * h scaled by ms
+};
+
+static struct IP5306_Platform platform;
+static struct IP5306_ChargeGovernor governor;
+static struct Adapter adapter;
+
+static int settingMa(void) {
+    uint8_t data = mockRegs[IP5306_REG_CHG_DIG_CTL0_ADDR];
+    return 50 + (data & 0x1f) * 100;
+}
+
+static void simulateAdapter(void) {
+    bool full = adapter.chargedUah >= (int64_t)adapter.batteryMah * 1000;
+    bool charging = false;
+
+    if (adapter.plugged && !full) {
+        if (adapter.sagEndTime && (int32_t)(mockTime - adapter.sagEndTime) >= 0) {
+            adapter.sagEndTime = 0;
+        }
+
+        if (!adapter.sagEndTime && settingMa() > adapter.limitMa) {
+            adapter.sagEndTime = mockTime + (uint32_t)adapter.recoveryMs;
+        }
+
+        charging = !adapter.sagEndTime;
+        if (charging) {
+            adapter.chargedUah += (int64_t)settingMa() * TICK_MS / 3600;
+        }
+    }
+
+    mockRegs[IP5306_REG_READ0_ADDR] = charging ? 0x08 : 0x00;
+    mockRegs[IP5306_REG_READ1_ADDR] = adapter.plugged && full ? 0x08 : 0x00;
+    mockRegs[IP5306_REG_READ2_ADDR] = 0x04; // Light load
+}
+
+static void run(int ticks) {
+    for (int i = 0; i < ticks; i++) {
+        mockTime += TICK_MS;
+        simulateAdapter();
+        IP5306_Step(&platform, mockTime);
+        CHECK(IP5306_ChargeGovernorStep(&governor, &platform, mockTime), "step failed");
+        CHECK(settingMa() == governor.chargerControl.chargingCurrent, "register %d != governor %d mA",
+            settingMa(), governor.chargerControl.chargingCurrent);
+    }
+}
+
+static void init(int limitMa) {
+    mockPlatformInit(&platform);
+    IP5306_Init(&platform);
+    IP5306_Step(&platform, mockTime);
+
+    adapter.plugged = true;
+    adapter.limitMa = limitMa;
+    adapter.recoveryMs = 2000;
+    adapter.sagEndTime = 0;
+    adapter.batteryMah = 100000;
+    adapter.chargedUah = 0;
+
+    struct IP5306_ChargeGovernorConfig config = {
+        .minCurrent = 500,
+        .maxCurrent = 2450,
+        .currentStep = 200,
+        .stepPeriodMs = TICK_MS,
+        .backoffHoldMs = 600000,
+        .sagRecoveryMs = 5000,
+        .undervoltageLoop = IP5306_ChargingUndervoltageLoop_4V7
+    };
+    CHECK(IP5306_ChargeGovernorInit(&governor, &platform, &config), "init failed");
+    CHECK(governor.config.minCurrent == 550 && governor.config.maxCurrent == 2450, "config not snapped to grid");
+}
+
+static void testRampUp(void) {
+    init(3000);
+    run(20);
+
+    CHECK(governor.chargerControl.chargingCurrent == 2350, "strong adapter ramps to %d mA", governor.chargerControl.chargingCurrent);
+    CHECK(governor.stepUpCount == 9, "step ups %u", governor.stepUpCount);
+    CHECK(governor.backoffCount == 0 && governor.unplugCount == 0, "no sag or unplug expected");
+}
+
+static void testSagBackoff(void) {
+    init(1400);
+    run(30);
+
+    // 1550 mA collapses the adapter, ceiling drops one step below it and the governor settles there
+    CHECK(governor.backoffCount == 1, "backoffs %u", governor.backoffCount);
+    CHECK(governor.unplugCount == 0, "sag taken for unplug");
+    CHECK(governor.ceiling == 1350, "ceiling %d", governor.ceiling);
+    CHECK(governor.chargerControl.chargingCurrent == 1350, "settled at %d mA", governor.chargerControl.chargingCurrent);
+}
+
+static void testUnplug(void) {
+    init(1400);
+    run(30);
+
+    // Dropout longer than sagRecoveryMs is an unplug, the ceiling must not be lowered by it
+    adapter.plugged = false;
+    run(10);
+    CHECK(governor.unplugCount == 1, "unplugs %u", governor.unplugCount);
+    CHECK(governor.backoffCount == 1, "unplug counted as sag");
+    CHECK(governor.ceiling == governor.config.maxCurrent, "ceiling %d after unplug", governor.ceiling);
+    CHECK(governor.chargerControl.chargingCurrent == governor.config.minCurrent, "current %d while unplugged",
+        governor.chargerControl.chargingCurrent);
+
+    // Stronger adapter gets the full range
+    adapter.plugged = true;
+    adapter.limitMa = 3000;
+    run(20);
+    CHECK(governor.chargerControl.chargingCurrent == 2350, "new adapter ramps to %d mA", governor.chargerControl.chargingCurrent);
+    CHECK(governor.backoffCount == 1, "new adapter backed off");
+}
+
+static void testFullCharge(void) {
+    init(3000);
+    adapter.batteryMah = 10;
+    run(60);
+
+    CHECK(mockRegs[IP5306_REG_READ1_ADDR] & 0x08, "battery not full");
+    CHECK(governor.chargerControl.chargingCurrent == governor.config.minCurrent, "current %d after full",
+        governor.chargerControl.chargingCurrent);
+    CHECK(!governor.charging, "still charging after full");
+    CHECK(governor.unplugCount == 0 && governor.backoffCount == 0, "full charge taken for dropout");
+}
+
+int main(void) {
+    testRampUp();
+    testSagBackoff();
+    testUnplug();
+    testFullCharge();
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
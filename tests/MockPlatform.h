@@ -0,0 +1,86 @@
+// Simulated IP5306 platform for host tests: register file, millisecond clock and IRQ pin.
+// Time advances by 1 ms per bus transfer plus any delay or write wait.
+
+#ifndef MOCK_PLATFORM_H
+#define MOCK_PLATFORM_H
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "IP5306.h"
+
+static uint32_t mockTime = 1; // 0 is the invalid cycle time
+static uint8_t mockRegs[256];
+static int mockIrq = 1;
+static bool mockVerbose = false;
+
+static int mockWriteReg(uint8_t addr7bit, uint8_t regNum, const uint8_t *data, uint8_t length, uint8_t wait) {
+    (void)addr7bit;
+    mockTime += 1 + wait;
+    memcpy(&mockRegs[regNum], data, length);
+    return 0;
+}
+
+static int mockReadReg(uint8_t addr7bit, uint8_t regNum, uint8_t *data, uint8_t length, int timeout) {
+    (void)addr7bit;
+    (void)timeout;
+    mockTime += 1;
+    memcpy(data, &mockRegs[regNum], length);
+    return 0;
+}
+
+static void mockSetKeyGpioMode(enum IP5306_GpioMode mode) {
+    (void)mode;
+}
+
+static void mockSetKeyGpioPin(int value) {
+    (void)value;
+}
+
+static int mockGetIrqGpioPin(void) {
+    return mockIrq;
+}
+
+static uint32_t mockGetCycleTime(void) {
+    return mockTime;
+}
+
+static int32_t mockGetTimeDiffMs(uint32_t end, uint32_t start) {
+    return (int32_t)(end - start);
+}
+
+static void mockDelayMs(int ms) {
+    mockTime += (uint32_t)ms;
+}
+
+static void mockDebugPrint(const char *fmt, ...) {
+    if (!mockVerbose) {
+        return;
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    vprintf(fmt, args);
+    va_end(args);
+}
+
+static void mockPlatformInit(struct IP5306_Platform *platform) {
+    memset(platform, 0, sizeof(*platform));
+    memset(mockRegs, 0, sizeof(mockRegs));
+    mockTime = 1;
+    mockIrq = 1;
+
+    platform->i2cWriteReg = mockWriteReg;
+    platform->i2cReadReg = mockReadReg;
+    platform->setKeyGpioMode = mockSetKeyGpioMode;
+    platform->setKeyGpioPin = mockSetKeyGpioPin;
+    platform->getIrqGpioPin = mockGetIrqGpioPin;
+    platform->getCycleTime = mockGetCycleTime;
+    platform->getTimeDiffMs = mockGetTimeDiffMs;
+    platform->delayMs = mockDelayMs;
+    platform->debugPrint = mockDebugPrint;
+    platform->invalidCycleTimeValue = 0;
+}
+
+#endif // MOCK_PLATFORM_H
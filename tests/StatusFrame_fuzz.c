@@ -0,0 +1,93 @@
+// Fuzz harness for the status frame decoder: any accepted frame must re-encode to the same bytes.
+// libFuzzer: clang -fsanitize=fuzzer,address,undefined -DUSE_LIBFUZZER -I.. StatusFrame_fuzz.c ../IP5306_StatusFrame.c
+// AFL or replay: build without USE_LIBFUZZER and pass input files as arguments or on stdin.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "IP5306_StatusFrame.h"
+
+#define PREVIOUS_SIZE 4 // Leading input bytes which select the previous frame
+
+static void printBytes(const char *name, const uint8_t *data, int length) {
+    fprintf(stderr, "%s:", name);
+    for (int i = 0; i < length; i++) {
+        fprintf(stderr, " %02x", data[i]);
+    }
+    fprintf(stderr, "\n");
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size < PREVIOUS_SIZE) {
+        return 0;
+    }
+
+    struct IP5306_StatusFrame previous;
+    memset(&previous, 0, sizeof(previous));
+    previous.sequence = data[0];
+    previous.state = (enum IP5306_State)(data[1] % IP5306_STATE_COUNT);
+    previous.chargingOn = data[2] & 0x20;
+    previous.fullyCharged = data[2] & 0x10;
+    previous.lightLoad = data[2] & 0x08;
+    previous.doubleClick = data[2] & 0x04;
+    previous.longPress = data[2] & 0x02;
+    previous.shortPress = data[2] & 0x01;
+    previous.chargingCurrent = 50 + (data[3] & 0x1f) * 100;
+    previous.batteryLevel = (data[3] >> 5) % 5 * 25;
+
+    const uint8_t *frameData = data + PREVIOUS_SIZE;
+    int length = (int)(size - PREVIOUS_SIZE);
+
+    struct IP5306_StatusFrame frame;
+    if (!IP5306_StatusFrameDecode(&frame, &previous, frameData, length)) {
+        return 0;
+    }
+
+    // Full frames stand alone, deltas are encoded against the same previous frame
+    bool delta = frameData[0] & 0x10;
+    uint8_t encoded[IP5306_STATUS_FRAME_MAX_SIZE];
+    int encodedLength = IP5306_StatusFrameEncode(&frame, delta ? &previous : NULL, encoded, sizeof(encoded));
+
+    if (encodedLength != length || memcmp(encoded, frameData, (size_t)length) != 0) {
+        printBytes("previous", data, PREVIOUS_SIZE);
+        printBytes("input", frameData, length);
+        printBytes("encoded", encoded, encodedLength > 0 ? encodedLength : 0);
+        abort();
+    }
+
+    return 0;
+}
+
+#ifndef USE_LIBFUZZER
+
+static void runFile(FILE *file) {
+    uint8_t data[256];
+    size_t size = fread(data, 1, sizeof(data), file);
+
+    LLVMFuzzerTestOneInput(data, size);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        runFile(stdin);
+        return 0;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        FILE *file = fopen(argv[i], "rb");
+        if (!file) {
+            perror(argv[i]);
+            return 1;
+        }
+
+        runFile(file);
+        fclose(file);
+    }
+
+    return 0;
+}
+
+#endif
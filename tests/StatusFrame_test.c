@@ -0,0 +1,156 @@
+// Deterministic status frame tests: round trips of full and delta frames, sequence gaps, and an exhaustive
+// decode/re-encode check of every 2 and 3 byte input (all delta frames) and of full frames.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "IP5306_StatusFrame.h"
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+        failures++; \
+    } \
+} while (0)
+
+static bool sameFrame(const struct IP5306_StatusFrame *a, const struct IP5306_StatusFrame *b) {
+    return a->sequence == b->sequence && a->state == b->state &&
+        a->chargingOn == b->chargingOn && a->fullyCharged == b->fullyCharged && a->lightLoad == b->lightLoad &&
+        a->doubleClick == b->doubleClick && a->longPress == b->longPress && a->shortPress == b->shortPress &&
+        a->chargingCurrent == b->chargingCurrent && a->batteryLevel == b->batteryLevel;
+}
+
+static void makeFrame(struct IP5306_StatusFrame *frame, unsigned int seed) {
+    memset(frame, 0, sizeof(*frame));
+    frame->sequence = (uint8_t)seed;
+    frame->state = (enum IP5306_State)(seed % IP5306_STATE_COUNT);
+    frame->chargingOn = seed & 0x20;
+    frame->fullyCharged = seed & 0x40;
+    frame->lightLoad = seed & 0x80;
+    frame->doubleClick = seed & 0x100;
+    frame->longPress = seed & 0x200;
+    frame->shortPress = seed & 0x400;
+    frame->chargingCurrent = 50 + (int)(seed / 7 % 32) * 100;
+    frame->batteryLevel = (int)(seed / 3 % 5) * 25;
+}
+
+static void testRoundTrip(void) {
+    struct IP5306_StatusFrame previous;
+    struct IP5306_StatusFrame frame;
+    struct IP5306_StatusFrame decoded;
+    uint8_t buffer[IP5306_STATUS_FRAME_MAX_SIZE];
+
+    makeFrame(&previous, 0);
+    int length = IP5306_StatusFrameEncode(&previous, NULL, buffer, sizeof(buffer));
+    CHECK(length == IP5306_STATUS_FRAME_FULL_SIZE, "first frame length %d", length);
+    CHECK(IP5306_StatusFrameDecode(&decoded, NULL, buffer, length) && sameFrame(&decoded, &previous), "first frame");
+
+    for (unsigned int seed = 1; seed < 5000; seed++) {
+        makeFrame(&frame, seed);
+        frame.sequence = (uint8_t)(previous.sequence + 1);
+
+        length = IP5306_StatusFrameEncode(&frame, &previous, buffer, sizeof(buffer));
+        CHECK(length >= 2 && length <= IP5306_STATUS_FRAME_MAX_SIZE, "seed %u length %d", seed, length);
+        CHECK(IP5306_StatusFrameDecode(&decoded, &previous, buffer, length) && sameFrame(&decoded, &frame),
+            "seed %u round trip", seed);
+
+        previous = frame;
+    }
+
+    // Unchanged status costs two bytes
+    frame = previous;
+    frame.sequence++;
+    CHECK(IP5306_StatusFrameEncode(&frame, &previous, buffer, sizeof(buffer)) == 2, "unchanged delta");
+
+    // Too small buffer
+    CHECK(IP5306_StatusFrameEncode(&frame, NULL, buffer, 3) == -1, "small buffer");
+}
+
+static void testSequenceGap(void) {
+    struct IP5306_StatusFrame previous;
+    struct IP5306_StatusFrame frame;
+    struct IP5306_StatusFrame decoded;
+    uint8_t buffer[IP5306_STATUS_FRAME_MAX_SIZE];
+
+    makeFrame(&previous, 10);
+    frame = previous;
+    frame.sequence = (uint8_t)(previous.sequence + 2);
+
+    // Not consecutive, so a full frame which decodes without the previous one
+    int length = IP5306_StatusFrameEncode(&frame, &previous, buffer, sizeof(buffer));
+    CHECK(length == IP5306_STATUS_FRAME_FULL_SIZE, "gap length %d", length);
+    CHECK(IP5306_StatusFrameDecode(&decoded, NULL, buffer, length) && sameFrame(&decoded, &frame), "gap round trip");
+
+    // Sequence wraps around
+    previous.sequence = 255;
+    frame.sequence = 0;
+    length = IP5306_StatusFrameEncode(&frame, &previous, buffer, sizeof(buffer));
+    CHECK(length == 2, "wrap length %d", length);
+    CHECK(IP5306_StatusFrameDecode(&decoded, &previous, buffer, length) && sameFrame(&decoded, &frame), "wrap round trip");
+
+    // Delta after a lost frame is rejected
+    previous.sequence = 254;
+    CHECK(!IP5306_StatusFrameDecode(&decoded, &previous, buffer, length), "delta after lost frame");
+    CHECK(!IP5306_StatusFrameDecode(&decoded, NULL, buffer, length), "delta without previous");
+}
+
+static bool reencodes(const struct IP5306_StatusFrame *previous, const uint8_t *data, int length) {
+    struct IP5306_StatusFrame frame;
+    if (!IP5306_StatusFrameDecode(&frame, previous, data, length)) {
+        return true;
+    }
+
+    uint8_t encoded[IP5306_STATUS_FRAME_MAX_SIZE];
+    bool delta = data[0] & 0x10;
+    int encodedLength = IP5306_StatusFrameEncode(&frame, delta ? previous : NULL, encoded, sizeof(encoded));
+
+    return encodedLength == length && memcmp(encoded, data, (size_t)length) == 0;
+}
+
+static void testExhaustive(void) {
+    struct IP5306_StatusFrame previous;
+    uint8_t data[IP5306_STATUS_FRAME_FULL_SIZE];
+
+    for (unsigned int seed = 0; seed < 4; seed++) {
+        makeFrame(&previous, seed * 1234 + 7);
+
+        for (unsigned int value = 0; value < (1u << 24); value++) {
+            data[0] = (uint8_t)(value >> 16);
+            data[1] = (uint8_t)(value >> 8);
+            data[2] = (uint8_t)value;
+
+            if ((value & 0xff) == 0) {
+                CHECK(reencodes(&previous, data, 2), "2 bytes %02x %02x", data[0], data[1]);
+            }
+            CHECK(reencodes(&previous, data, 3), "3 bytes %02x %02x %02x", data[0], data[1], data[2]);
+        }
+    }
+
+    // Full frames: version and delta bits fixed, the rest exhaustive
+    for (unsigned int value = 0; value < (1u << 28); value += 97) {
+        data[0] = (uint8_t)(0x20 | (value >> 24));
+        data[1] = (uint8_t)(value >> 16);
+        data[2] = (uint8_t)(value >> 8);
+        data[3] = (uint8_t)value;
+
+        CHECK(reencodes(NULL, data, 4), "4 bytes %02x %02x %02x %02x", data[0], data[1], data[2], data[3]);
+    }
+}
+
+int main(void) {
+    testRoundTrip();
+    testSequenceGap();
+    testExhaustive();
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,170 @@
+// Trace round trip: records written through the writer callback are decoded back unchanged, and the analyzer
+// (built as ./IP5306_TraceAnalyzer) reports the same counts and residency whether or not intervals span chunk boundaries.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+
+#include "IP5306_Trace.h"
+
+#define TRACE_FILE "TraceRoundTrip_test.trace"
+#define ANALYZER "./IP5306_TraceAnalyzer"
+#define MAX_TRACE_SIZE (IP5306_TRACE_HEADER_SIZE + 64 * IP5306_TRACE_RECORD_SIZE)
+#define OUTPUT_SIZE 4096
+
+#define SHORT_PRESS 0x01
+#define LONG_PRESS 0x02
+#define DOUBLE_CLICK 0x04
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+        failures++; \
+    } \
+} while (0)
+
+struct Sample {
+    uint32_t deviceId;
+    uint64_t timestampMs;
+    enum IP5306_State state;
+    bool chargingOn;
+    bool fullyCharged;
+    uint8_t keys; // READ3 bits 0..2
+};
+
+// Two interleaved devices, 12 records: with 3 threads every chunk holds 4 records, so records 3/4 and 7/8 are
+// chunk boundaries and the intervals of both devices across them are stitched by the merge
+static const struct Sample samples[] = {
+    { 1, 0, IP5306_State_Working, false, false, 0 },
+    { 2, 0, IP5306_State_Sleep, false, false, 0 },
+    { 1, 1000, IP5306_State_Working, true, false, 0 }, // Charge cycle
+    { 2, 5000, IP5306_State_Sleep, false, false, SHORT_PRESS },
+    { 1, 61000, IP5306_State_Sleep, true, true, 0 }, // Working interval spans the boundary, full charge
+    { 2, 6000, IP5306_State_WakingUp, true, false, 0 }, // Charge cycle across the boundary
+    { 1, 70000, IP5306_State_Sleep, false, true, 0 },
+    { 2, 6500, IP5306_State_Working, true, false, LONG_PRESS },
+    { 1, 71000, IP5306_State_Working, true, false, 0 }, // Charge cycle across the boundary
+    { 2, 9000, IP5306_State_Working, true, false, DOUBLE_CLICK },
+    { 1, 72000, IP5306_State_ShuttingDown, true, false, 0 },
+    { 2, 9000, IP5306_State_Working, true, false, 0 },
+};
+
+#define SAMPLE_COUNT ((int)(sizeof(samples) / sizeof(samples[0])))
+
+static const char *expectedDevices[] = {
+    "device 1: records 6, charge cycles 2, full charges 1, short presses 0, long presses 0, double clicks 0\n"
+    "  residency ms: unknown 0, sleep 10000, waking up 0, working 62000, shutting down 0\n",
+    "device 2: records 6, charge cycles 1, full charges 0, short presses 1, long presses 1, double clicks 1\n"
+    "  residency ms: unknown 0, sleep 6000, waking up 500, working 2500, shutting down 0\n",
+};
+
+struct Storage {
+    uint8_t data[MAX_TRACE_SIZE];
+    int length;
+};
+
+static bool storageWrite(const uint8_t *data, int length, void *context) {
+    struct Storage *storage = context;
+    if (storage->length + length > MAX_TRACE_SIZE) {
+        return false;
+    }
+
+    memcpy(&storage->data[storage->length], data, (size_t)length);
+    storage->length += length;
+
+    return true;
+}
+
+static void fillRecord(struct IP5306_TraceRecord *record, const struct Sample *sample) {
+    struct IP5306_Platform platform;
+    struct IP5306_Status status;
+
+    memset(&platform, 0, sizeof(platform));
+    memset(&status, 0, sizeof(status));
+    platform.state = sample->state;
+    status.read0RegData = sample->chargingOn ? 0x08 : 0x00;
+    status.read1RegData = sample->fullyCharged ? 0x08 : 0x00;
+    status.read3RegData = sample->keys;
+
+    IP5306_TraceFillRecord(record, &platform, NULL, NULL, &status, IP5306_READ_ALL_BITS, sample->timestampMs, sample->deviceId);
+}
+
+static bool runAnalyzer(int threads, char *output) {
+    char command[128];
+    snprintf(command, sizeof(command), "%s %s %d", ANALYZER, TRACE_FILE, threads);
+
+    FILE *pipe = popen(command, "r");
+    if (!pipe) {
+        return false;
+    }
+
+    size_t length = fread(output, 1, OUTPUT_SIZE - 1, pipe);
+    output[length] = '\0';
+
+    return pclose(pipe) == 0;
+}
+
+int main(void) {
+    static struct Storage storage;
+    struct IP5306_TraceWriter writer = { storageWrite, &storage, 0 };
+    struct IP5306_TraceRecord records[SAMPLE_COUNT];
+
+    CHECK(IP5306_TraceWriterBegin(&writer), "header written");
+    for (int i = 0; i < SAMPLE_COUNT; i++) {
+        fillRecord(&records[i], &samples[i]);
+        CHECK(IP5306_TraceWriterAppend(&writer, &records[i]), "record %d written", i);
+    }
+
+    CHECK(writer.records == SAMPLE_COUNT, "writer counted %u records", (unsigned)writer.records);
+    CHECK(storage.length == IP5306_TRACE_HEADER_SIZE + SAMPLE_COUNT * IP5306_TRACE_RECORD_SIZE, "trace size %d", storage.length);
+    CHECK(IP5306_TraceDecodeHeader(storage.data, storage.length), "header decodes");
+
+    for (int i = 0; i < SAMPLE_COUNT; i++) {
+        struct IP5306_TraceRecord decoded;
+        const uint8_t *buffer = &storage.data[IP5306_TRACE_HEADER_SIZE + i * IP5306_TRACE_RECORD_SIZE];
+
+        CHECK(IP5306_TraceDecodeRecord(&decoded, buffer, IP5306_TRACE_RECORD_SIZE), "record %d decodes", i);
+        CHECK(decoded.timestampMs == records[i].timestampMs && decoded.deviceId == records[i].deviceId &&
+            decoded.regBits == records[i].regBits && decoded.state == records[i].state &&
+            memcmp(decoded.regData, records[i].regData, IP5306_REG_COUNT) == 0, "record %d round trip", i);
+    }
+
+    FILE *file = fopen(TRACE_FILE, "wb");
+    CHECK(file && fwrite(storage.data, 1, (size_t)storage.length, file) == (size_t)storage.length, "trace file written");
+    if (file) {
+        fclose(file);
+    }
+
+    // Single chunk, chunk boundaries between records 3/4 and 7/8, and a chunk per record
+    static const int threadCounts[] = { 1, 3, SAMPLE_COUNT };
+    for (size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); t++) {
+        char output[OUTPUT_SIZE];
+        char header[64];
+
+        if (!runAnalyzer(threadCounts[t], output)) {
+            CHECK(false, "analyzer failed with %d threads", threadCounts[t]);
+            continue;
+        }
+
+        snprintf(header, sizeof(header), "records %d, threads %d\n", SAMPLE_COUNT, threadCounts[t]);
+        CHECK(strncmp(output, header, strlen(header)) == 0, "%d threads header: %s", threadCounts[t], output);
+        for (size_t d = 0; d < sizeof(expectedDevices) / sizeof(expectedDevices[0]); d++) {
+            CHECK(strstr(output, expectedDevices[d]), "%d threads, expected:\n%sgot:\n%s", threadCounts[t], expectedDevices[d], output);
+        }
+    }
+
+    remove(TRACE_FILE);
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,291 @@
+// Offline analyzer for IP5306 register trace files (see IP5306_Trace.h).
+// Counts charge cycles, state residency and key events per device, splitting the file across threads.
+// Records of one device are expected in time order.
+//
+// Build: cc -O2 -pthread -I.. IP5306_TraceAnalyzer.c ../IP5306_Trace.c -o IP5306_TraceAnalyzer, or make -C tests IP5306_TraceAnalyzer
+// Usage: IP5306_TraceAnalyzer <trace file> [threads]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "BitOps.h"
+#include "IP5306_Trace.h"
+
+#define MAX_THREADS 256
+#define DEVICE_TABLE_SIZE 4096 // Power of two
+
+#define FLAG_CHARGING_ON 0x01
+#define FLAG_FULLY_CHARGED 0x02
+#define FLAG_SHORT_PRESS 0x04
+#define FLAG_LONG_PRESS 0x08
+#define FLAG_DOUBLE_CLICK 0x10
+
+
+struct Sample {
+    uint64_t timestampMs;
+    uint8_t state;
+    uint8_t flags;
+    uint8_t validFlags;
+};
+
+struct DeviceStats {
+    bool used;
+    uint32_t deviceId;
+    struct Sample first;
+    struct Sample last;
+
+    uint64_t records;
+    uint64_t chargeCycles; // Charging on rising edges
+    uint64_t fullCharges; // Fully charged rising edges
+    uint64_t shortPresses;
+    uint64_t longPresses;
+    uint64_t doubleClicks;
+    uint64_t stateResidencyMs[IP5306_STATE_COUNT];
+};
+
+struct Chunk {
+    const uint8_t *records;
+    uint64_t count;
+    struct DeviceStats *devices;
+    bool overflow;
+};
+
+
+static struct Sample toSample(const struct IP5306_TraceRecord *record) {
+    struct Sample sample;
+
+    sample.timestampMs = record->timestampMs;
+    sample.state = record->state < IP5306_STATE_COUNT ? record->state : IP5306_State_Unknown;
+    sample.flags = 0;
+    sample.validFlags = 0;
+
+    if (record->regBits & IP5306_READ0_BIT) {
+        sample.validFlags |= FLAG_CHARGING_ON;
+        sample.flags |= BITOPS_GET_BIT(record->regData[IP5306_TRACE_READ0], 3) ? FLAG_CHARGING_ON : 0;
+    }
+
+    if (record->regBits & IP5306_READ1_BIT) {
+        sample.validFlags |= FLAG_FULLY_CHARGED;
+        sample.flags |= BITOPS_GET_BIT(record->regData[IP5306_TRACE_READ1], 3) ? FLAG_FULLY_CHARGED : 0;
+    }
+
+    if (record->regBits & IP5306_READ3_BIT) {
+        uint8_t read3 = record->regData[IP5306_TRACE_READ3];
+        sample.validFlags |= FLAG_SHORT_PRESS | FLAG_LONG_PRESS | FLAG_DOUBLE_CLICK;
+        sample.flags |= BITOPS_GET_BIT(read3, 0) ? FLAG_SHORT_PRESS : 0;
+        sample.flags |= BITOPS_GET_BIT(read3, 1) ? FLAG_LONG_PRESS : 0;
+        sample.flags |= BITOPS_GET_BIT(read3, 2) ? FLAG_DOUBLE_CLICK : 0;
+    }
+
+    return sample;
+}
+
+static bool isRisingEdge(const struct Sample *prev, const struct Sample *cur, uint8_t flag) {
+    return (prev->validFlags & cur->validFlags & flag) && !(prev->flags & flag) && (cur->flags & flag);
+}
+
+// Accounts the interval between two consecutive samples of one device
+static void addTransition(struct DeviceStats *device, const struct Sample *prev, const struct Sample *cur) {
+    if (cur->timestampMs > prev->timestampMs) {
+        device->stateResidencyMs[prev->state] += cur->timestampMs - prev->timestampMs;
+    }
+
+    device->chargeCycles += isRisingEdge(prev, cur, FLAG_CHARGING_ON);
+    device->fullCharges += isRisingEdge(prev, cur, FLAG_FULLY_CHARGED);
+    device->shortPresses += isRisingEdge(prev, cur, FLAG_SHORT_PRESS);
+    device->longPresses += isRisingEdge(prev, cur, FLAG_LONG_PRESS);
+    device->doubleClicks += isRisingEdge(prev, cur, FLAG_DOUBLE_CLICK);
+}
+
+static struct DeviceStats *findDevice(struct DeviceStats *devices, uint32_t deviceId) {
+    uint32_t index = (deviceId * 2654435761u) & (DEVICE_TABLE_SIZE - 1);
+
+    for (int probe = 0; probe < DEVICE_TABLE_SIZE; probe++) {
+        struct DeviceStats *device = &devices[(index + probe) & (DEVICE_TABLE_SIZE - 1)];
+        if (!device->used) {
+            memset(device, 0, sizeof(*device));
+            device->used = true;
+            device->deviceId = deviceId;
+            return device;
+        }
+        if (device->deviceId == deviceId) {
+            return device;
+        }
+    }
+
+    return NULL;
+}
+
+static void *analyzeChunk(void *arg) {
+    struct Chunk *chunk = arg;
+
+    for (uint64_t i = 0; i < chunk->count; i++) {
+        struct IP5306_TraceRecord record;
+        IP5306_TraceDecodeRecord(&record, chunk->records + i * IP5306_TRACE_RECORD_SIZE, IP5306_TRACE_RECORD_SIZE);
+
+        struct DeviceStats *device = findDevice(chunk->devices, record.deviceId);
+        if (!device) {
+            chunk->overflow = true;
+            return NULL;
+        }
+
+        struct Sample sample = toSample(&record);
+        if (device->records == 0) {
+            device->first = sample;
+        } else {
+            addTransition(device, &device->last, &sample);
+        }
+        device->last = sample;
+        device->records++;
+    }
+
+    return NULL;
+}
+
+// Appends statistics of a later chunk, stitching the boundary between the chunks
+static bool mergeChunk(struct DeviceStats *total, const struct DeviceStats *devices) {
+    for (int i = 0; i < DEVICE_TABLE_SIZE; i++) {
+        const struct DeviceStats *src = &devices[i];
+        if (!src->used) {
+            continue;
+        }
+
+        struct DeviceStats *dst = findDevice(total, src->deviceId);
+        if (!dst) {
+            return false;
+        }
+
+        if (dst->records == 0) {
+            dst->first = src->first;
+        } else {
+            addTransition(dst, &dst->last, &src->first);
+        }
+
+        dst->last = src->last;
+        dst->records += src->records;
+        dst->chargeCycles += src->chargeCycles;
+        dst->fullCharges += src->fullCharges;
+        dst->shortPresses += src->shortPresses;
+        dst->longPresses += src->longPresses;
+        dst->doubleClicks += src->doubleClicks;
+        for (int state = 0; state < IP5306_STATE_COUNT; state++) {
+            dst->stateResidencyMs[state] += src->stateResidencyMs[state];
+        }
+    }
+
+    return true;
+}
+
+static void printDevice(const struct DeviceStats *device) {
+    printf("device %" PRIu32 ": records %" PRIu64 ", charge cycles %" PRIu64 ", full charges %" PRIu64
+        ", short presses %" PRIu64 ", long presses %" PRIu64 ", double clicks %" PRIu64 "\n",
+        device->deviceId, device->records, device->chargeCycles, device->fullCharges,
+        device->shortPresses, device->longPresses, device->doubleClicks);
+    printf("  residency ms: unknown %" PRIu64 ", sleep %" PRIu64 ", waking up %" PRIu64
+        ", working %" PRIu64 ", shutting down %" PRIu64 "\n",
+        device->stateResidencyMs[IP5306_State_Unknown], device->stateResidencyMs[IP5306_State_Sleep],
+        device->stateResidencyMs[IP5306_State_WakingUp], device->stateResidencyMs[IP5306_State_Working],
+        device->stateResidencyMs[IP5306_State_ShuttingDown]);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "Usage: %s <trace file> [threads]\n", argv[0]);
+        return 2;
+    }
+
+    long threadCount = argc == 3 ? strtol(argv[2], NULL, 10) : sysconf(_SC_NPROCESSORS_ONLN);
+    if (threadCount < 1) {
+        threadCount = 1;
+    }
+    if (threadCount > MAX_THREADS) {
+        threadCount = MAX_THREADS;
+    }
+
+    int fd = open(argv[1], O_RDONLY);
+    if (fd < 0) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < IP5306_TRACE_HEADER_SIZE) {
+        fprintf(stderr, "%s: not a trace file\n", argv[1]);
+        close(fd);
+        return 1;
+    }
+
+    const uint8_t *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    if (!IP5306_TraceDecodeHeader(data, IP5306_TRACE_HEADER_SIZE)) {
+        fprintf(stderr, "%s: bad trace header\n", argv[1]);
+        return 1;
+    }
+
+    uint64_t recordCount = (uint64_t)(st.st_size - IP5306_TRACE_HEADER_SIZE) / IP5306_TRACE_RECORD_SIZE;
+    if ((uint64_t)threadCount > recordCount && recordCount > 0) {
+        threadCount = (long)recordCount;
+    }
+    posix_madvise((void *)data, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+
+    struct Chunk chunks[MAX_THREADS];
+    pthread_t threads[MAX_THREADS];
+    uint64_t perThread = recordCount / (uint64_t)threadCount;
+
+    for (long i = 0; i < threadCount; i++) {
+        uint64_t start = (uint64_t)i * perThread;
+        chunks[i].records = data + IP5306_TRACE_HEADER_SIZE + start * IP5306_TRACE_RECORD_SIZE;
+        chunks[i].count = i == threadCount - 1 ? recordCount - start : perThread;
+        chunks[i].devices = calloc(DEVICE_TABLE_SIZE, sizeof(struct DeviceStats));
+        chunks[i].overflow = false;
+        if (!chunks[i].devices || pthread_create(&threads[i], NULL, analyzeChunk, &chunks[i]) != 0) {
+            fprintf(stderr, "Failed to start worker %ld\n", i);
+            return 1;
+        }
+    }
+
+    struct DeviceStats *total = calloc(DEVICE_TABLE_SIZE, sizeof(struct DeviceStats));
+    if (!total) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    // Chunks are merged in file order so boundaries are stitched correctly
+    bool overflow = false;
+    for (long i = 0; i < threadCount; i++) {
+        pthread_join(threads[i], NULL);
+        overflow |= chunks[i].overflow || !mergeChunk(total, chunks[i].devices);
+        free(chunks[i].devices);
+    }
+
+    if (overflow) {
+        fprintf(stderr, "More than %d devices in trace\n", DEVICE_TABLE_SIZE);
+        return 1;
+    }
+
+    printf("records %" PRIu64 ", threads %ld\n", recordCount, threadCount);
+    for (int i = 0; i < DEVICE_TABLE_SIZE; i++) {
+        if (total[i].used) {
+            printDevice(&total[i]);
+        }
+    }
+
+    free(total);
+    munmap((void *)data, (size_t)st.st_size);
+
+    return 0;
+}